@@ -26,6 +26,42 @@ class ICommand {
    * @param model Ссылка на модель, к которой применяется команда.
    */
   virtual void execute(Model &model) = 0;
+
+  /**
+   * @enum History
+   * @brief Как команда учитывается в истории отмены (см. Controller::undo).
+   */
+  enum class History {
+    Skip,   /**< Настройка, не меняющая модель (кэш, потоки). */
+    Record, /**< Преобразование, которое можно отменить. */
+    Clear   /**< Замена модели целиком, история сбрасывается. */
+  };
+
+  /**
+   * @brief Как команда учитывается в истории отмены.
+   */
+  virtual History history() const { return History::Skip; }
+
+  /**
+   * @brief Может ли команда менять вершины или треугольники модели.
+   *
+   * Перед такой командой контроллер останавливает фоновую работу, читающую
+   * геометрию (сборку уровней детализации).
+   */
+  virtual bool changesGeometry() const { return false; }
+
+  /**
+   * @brief Пытается учесть в этой команде следующую за ней.
+   * @param next Команда, поставленная в очередь сразу после этой.
+   * @return true, если `next` объединена с этой и выполнять её не нужно.
+   *
+   * Используется очередью команд контроллера, чтобы серия однотипных
+   * преобразований выполнялась как одно.
+   */
+  virtual bool merge(const ICommand &next) {
+    (void)next;
+    return false;
+  }
 };
 
 // ==================== Конкретные команды ====================
@@ -35,11 +71,63 @@ class ICommand {
  */
 class OpenFileCommand : public ICommand {
  public:
-  explicit OpenFileCommand(std::string fname) : filename_(std::move(fname)) {}
-  void execute(Model &model) override { model.openModel(filename_); }
+  /**
+   * @brief Конструктор.
+   * @param fname Путь к файлу.
+   * @param threads Число потоков разбора файла.
+   */
+  explicit OpenFileCommand(std::string fname, unsigned threads = 1)
+      : filename_(std::move(fname)), threads_(threads) {}
+  void execute(Model &model) override { model.openModel(filename_, threads_); }
+  History history() const override { return History::Clear; }
+  bool changesGeometry() const override { return true; }
 
  private:
   std::string filename_;
+  unsigned threads_;
+};
+
+/**
+ * @class CacheCommand
+ * @brief Команда включения или выключения двоичного кэша моделей.
+ */
+class CacheCommand : public ICommand {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param enabled Использовать ли кэш.
+   * @param dir Каталог кэша; пустая строка — рядом с исходным файлом.
+   * @param limit Наибольший размер каталога кэша в байтах; 0 — без
+   * ограничения.
+   */
+  explicit CacheCommand(bool enabled, std::string dir = "",
+                        uint64_t limit = 0)
+      : enabled_(enabled), dir_(std::move(dir)), limit_(limit) {}
+  void execute(Model &model) override {
+    model.setCache(enabled_, dir_, limit_);
+  }
+
+ private:
+  bool enabled_;
+  std::string dir_;
+  uint64_t limit_;
+};
+
+/**
+ * @class ThreadsCommand
+ * @brief Команда выбора числа потоков для обработки вершин модели.
+ */
+class ThreadsCommand : public ICommand {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param threads Число потоков; 0 и 1 — последовательная обработка.
+   */
+  explicit ThreadsCommand(unsigned threads) : threads_(threads) {}
+  void execute(Model &model) override { model.setThreads(threads_); }
+
+ private:
+  unsigned threads_;
 };
 
 /**
@@ -49,6 +137,29 @@ class OpenFileCommand : public ICommand {
 class NormalizeCommand : public ICommand {
  public:
   void execute(Model &model) override { model.normalization(); }
+  History history() const override { return History::Record; }
+};
+
+/**
+ * @class ResetCommand
+ * @brief Команда возврата модели к исходному виду без чтения файла.
+ */
+class ResetCommand : public ICommand {
+ public:
+  void execute(Model &model) override { model.reset(); }
+  History history() const override { return History::Record; }
+  bool changesGeometry() const override { return true; }
+};
+
+/**
+ * @class BakeCommand
+ * @brief Команда переноса накопленного преобразования в вершины.
+ */
+class BakeCommand : public ICommand {
+ public:
+  void execute(Model &model) override { model.bake(); }
+  History history() const override { return History::Record; }
+  bool changesGeometry() const override { return true; }
 };
 
 /**
@@ -64,10 +175,25 @@ class ScaleCommand : public ICommand {
    */
   ScaleCommand(float factor, bool zoomOut) : factor_(factor), def_(zoomOut) {}
   void execute(Model &model) override { model.scale(factor_, def_); }
+  History history() const override { return History::Record; }
+
+  /**
+   * @brief Масштабы перемножаются; шаг по умолчанию (factor = 0)
+   * не объединяется.
+   */
+  bool merge(const ICommand &next) override {
+    auto other = dynamic_cast<const ScaleCommand *>(&next);
+    if (!other || !factor_ || !other->factor_) return false;
+    factor_ = effective() * other->effective();
+    def_ = false;
+    return true;
+  }
 
  private:
   float factor_;
   bool def_;
+
+  float effective() const { return def_ ? 1 / factor_ : factor_; }
 };
 
 /**
@@ -83,6 +209,17 @@ class TranslateCommand : public ICommand {
    */
   TranslateCommand(Vertex v, bool useDefault) : vertex_(v), def_(useDefault) {}
   void execute(Model &model) override { model.translate(vertex_, def_); }
+  History history() const override { return History::Record; }
+
+  /**
+   * @brief Сдвиги складываются, если у них один и тот же режим шага.
+   */
+  bool merge(const ICommand &next) override {
+    auto other = dynamic_cast<const TranslateCommand *>(&next);
+    if (!other || other->def_ != def_) return false;
+    vertex_ = vertex_ + other->vertex_;
+    return true;
+  }
 
  private:
   Vertex vertex_;
@@ -102,10 +239,58 @@ class RotateCommand : public ICommand {
    */
   RotateCommand(Vertex v, bool useDefault) : vertex_(v), def_(useDefault) {}
   void execute(Model &model) override { model.rotate(vertex_, def_); }
+  History history() const override { return History::Record; }
+
+  /**
+   * @brief Углы складываются только для поворотов вокруг одной и той же
+   * оси: повороты вокруг разных осей не перестановочны.
+   */
+  bool merge(const ICommand &next) override {
+    auto other = dynamic_cast<const RotateCommand *>(&next);
+    if (!other || other->def_ != def_) return false;
+    int axis = single_axis(), other_axis = other->single_axis();
+    if (axis < 0 || axis != other_axis) return false;
+    vertex_ = vertex_ + other->vertex_;
+    return true;
+  }
 
  private:
   Vertex vertex_;
   bool def_;
+
+  /**
+   * @brief Номер единственной ненулевой оси (0..2) или -1.
+   */
+  int single_axis() const {
+    int axis = -1;
+    const float angles[] = {vertex_.x, vertex_.y, vertex_.z};
+    for (int i = 0; i < 3; i++) {
+      if (angles[i] == 0) continue;
+      if (axis >= 0) return -1;
+      axis = i;
+    }
+    return axis;
+  }
+};
+
+/**
+ * @class CompositeRotateCommand
+ * @brief Команда поворота произвольной матрицей: углы Эйлера, ось и угол
+ * или кватернион (см. RotateComposite).
+ */
+class CompositeRotateCommand : public ICommand {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param rotation Поворот, например `RotateComposite::axis_angle(...)`.
+   */
+  explicit CompositeRotateCommand(RotateComposite rotation)
+      : rotation_(rotation) {}
+  void execute(Model &model) override { model.rotate(rotation_); }
+  History history() const override { return History::Record; }
+
+ private:
+  RotateComposite rotation_;
 };
 
 }  // namespace s21
@@ -5,6 +5,15 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "../model/load_preview.h"
+#include "../model/mesh_lod.h"
 #include "commands.h"
 
 namespace s21 {
@@ -24,13 +33,433 @@ class Controller {
    */
   Model model_;
 
+  /**
+   * @brief Модель, собираемая в фоновом потоке.
+   */
+  std::future<Model> loading_;
+
+  /**
+   * @brief Отменённые загрузки, которые ещё не заметили отмену.
+   *
+   * Фоновый поток владеет всеми своими данными, поэтому cancelLoad() не
+   * ждёт его, а откладывает future сюда. Готовые удаляются при следующей
+   * отмене; деструктор дожидается остальных.
+   */
+  std::vector<std::future<Model>> abandoned_;
+
+  /**
+   * @brief Прогресс фоновой загрузки (разделяется с фоновым потоком).
+   */
+  std::shared_ptr<Load_progress> progress_;
+
+  /**
+   * @brief Частично загруженная модель (только при постепенном показе).
+   */
+  std::shared_ptr<Load_preview> preview_;
+
+  /**
+   * @brief Уровни детализации, собираемые в фоновом потоке.
+   */
+  std::future<Lod_levels> lod_loading_;
+
+  /**
+   * @brief Флаг отмены фоновой сборки уровней.
+   */
+  std::shared_ptr<std::atomic<bool>> lod_cancelled_;
+
+  /**
+   * @brief Готовые уровни детализации текущей геометрии.
+   */
+  Lod_levels lods_;
+
+  /**
+   * @brief Запись разобранной модели в кэш, идущая в фоновом потоке.
+   */
+  std::future<void> cache_saving_;
+
+  /**
+   * @struct History_entry
+   * @brief Выполненная команда и то, что нужно для её отмены.
+   *
+   * Хранится не копия вершин, а матрица до команды, поэтому шаг истории
+   * занимает десятки байт независимо от размера модели.
+   */
+  struct History_entry {
+    std::unique_ptr<ICommand> command; /**< Команда (для повтора). */
+    Matrix4 before;                    /**< transform до команды. */
+    bool changes_geometry;             /**< Команда меняла вершины. */
+  };
+
+  /**
+   * @brief История: `[0, position_)` выполнены, остальные отменены.
+   */
+  std::deque<History_entry> history_;
+  size_t position_ = 0;
+
+  /**
+   * @brief Можно ли восстановить состояние повтором истории с загруженной
+   * геометрии (нельзя, если из неё вытеснена команда, менявшая вершины).
+   */
+  bool replayable_ = true;
+
+  /**
+   * @brief Восстанавливает состояние после первых `count` команд истории:
+   * возвращает загруженную геометрию и повторяет команды.
+   *
+   * Матрица берётся из первой записи: вытесненные из истории команды
+   * меняли только её.
+   */
+  void replay(size_t count) {
+    bool building = isBuildingLod();
+    stopReaders();
+    uint64_t geometry = model_.geometryVersion();
+    model_.reset();
+    model_.transform = history_.front().before;
+    for (size_t i = 0; i < count; i++) history_[i].command->execute(model_);
+    if (building || geometry != model_.geometryVersion()) buildLodAsync();
+  }
+
+  /**
+   * @brief Выполняет команду над моделью.
+   *
+   * Перед командой, которая может менять геометрию, фоновые потоки,
+   * читающие модель, останавливаются; после неё уровни собираются заново,
+   * если геометрия действительно изменилась или сборка была прервана.
+   * Модель, которую команда разобрала из файла, записывается в кэш.
+   */
+  void apply(ICommand &cmd) {
+    if (!cmd.changesGeometry()) {
+      cmd.execute(model_);
+      return;
+    }
+    bool building = isBuildingLod();
+    stopReaders();
+    uint64_t geometry = model_.geometryVersion();
+    cmd.execute(model_);
+    if (building || geometry != model_.geometryVersion() ||
+        cmd.history() == ICommand::History::Clear)
+      buildLodAsync();
+    saveCacheAsync();
+  }
+
+  /**
+   * @brief Запускает фоновую сборку уровней детализации текущей геометрии.
+   *
+   * Поток читает вершины и треугольники модели без копирования, поэтому
+   * всё, что их меняет или заменяет модель, сначала вызывает stopReaders().
+   * Маленьким моделям уровни не нужны.
+   */
+  void buildLodAsync() {
+    cancelLod();
+    lods_.clear();
+    if (model_.polygons.size() < Mesh_simplifier::kMinTriangles) return;
+    lod_cancelled_ = std::make_shared<std::atomic<bool>>(false);
+    lod_loading_ = std::async(
+        std::launch::async,
+        [&vertices = model_.vertices, &polygons = model_.polygons,
+         cancelled = lod_cancelled_] {
+          return Mesh_simplifier(cancelled.get()).build(vertices, polygons);
+        });
+  }
+
+  /**
+   * @brief Останавливает фоновую сборку уровней и ждёт её завершения.
+   *
+   * Поток читает модель по ссылке, поэтому ожидание нужно; оно короткое:
+   * каждый этап упрощения и сборки рёбер проверяет флаг между небольшими
+   * порциями работы (см. unique_edges()).
+   */
+  void cancelLod() {
+    if (!isBuildingLod()) return;
+    *lod_cancelled_ = true;
+    lod_loading_.wait();
+    lod_loading_ = {};
+  }
+
+  /**
+   * @brief Записывает в кэш модель, только что разобранную из файла.
+   *
+   * Запись больших моделей занимает заметное время, поэтому идёт в фоновом
+   * потоке уже после того, как модель показана. Поток читает модель по
+   * ссылке (см. stopReaders()), а кэш копирует: его можно переключать.
+   */
+  void saveCacheAsync() {
+    std::string source = model_.takeUnsavedSource();
+    if (source.empty() || !model_.cache()) return;
+    waitCacheSave();
+    cache_saving_ = std::async(
+        std::launch::async,
+        [&model = model_, cache = *model_.cache(), source = std::move(source)] {
+          cache.save(source, model.vertices, model.polygons,
+                     model.raw_polygons, model.edges, model.bvh);
+        });
+  }
+
+  /**
+   * @brief Ждёт завершения фоновой записи в кэш.
+   */
+  void waitCacheSave() {
+    if (!cache_saving_.valid()) return;
+    cache_saving_.wait();
+    cache_saving_ = {};
+  }
+
+  /**
+   * @brief Останавливает все фоновые потоки, читающие модель по ссылке:
+   * сборку уровней прерывает, запись в кэш дожидается.
+   */
+  void stopReaders() {
+    cancelLod();
+    waitCacheSave();
+  }
+
+  /**
+   * @brief Команды, ждущие выполнения (см. enqueueCommand()).
+   */
+  std::vector<std::unique_ptr<ICommand>> queue_;
+
+  /**
+   * @brief Выполняет команду и записывает её в историю.
+   */
+  void run(std::unique_ptr<ICommand> cmd) {
+    ICommand::History kind = cmd->history();
+    if (kind != ICommand::History::Record) {
+      apply(*cmd);
+      if (kind == ICommand::History::Clear) clearHistory();
+      return;
+    }
+    Matrix4 before = model_.transform;
+    uint64_t geometry = model_.geometryVersion();
+    apply(*cmd);
+    history_.erase(history_.begin() + position_, history_.end());
+    history_.push_back(
+        {std::move(cmd), before, geometry != model_.geometryVersion()});
+    if (history_.size() > kHistoryLimit) {
+      if (history_.front().changes_geometry) replayable_ = false;
+      history_.pop_front();
+    }
+    position_ = history_.size();
+  }
+
  public:
+  /**
+   * @brief Максимальная длина истории отмены.
+   */
+  static constexpr size_t kHistoryLimit = 500;
+
+  ~Controller() {
+    cancelLoad();
+    stopReaders();
+    abandoned_.clear();
+  }
+
+  /**
+   * @brief Запускает загрузку модели в фоновом потоке.
+   * @param fname Путь к файлу.
+   * @param threads Число потоков разбора файла.
+   * @param progressive Выкладывать ли разобранную часть в loadPreview().
+   *
+   * Предыдущая незавершённая загрузка отменяется. Текущая модель остаётся
+   * доступной для команд, пока новая не будет принята finishLoad().
+   */
+  void loadModelAsync(std::string fname, unsigned threads = 1,
+                      bool progressive = false) {
+    cancelLoad();
+    progress_ = std::make_shared<Load_progress>();
+    if (progressive) {
+      preview_ = std::make_shared<Load_preview>();
+      progress_->preview = preview_.get();
+    }
+    auto next = std::make_unique<Model>();
+    next->copySettings(model_);
+    loading_ = std::async(
+        std::launch::async,
+        [fname = std::move(fname), threads, progress = progress_,
+         preview = preview_, next = std::move(next)]() mutable {
+          next->openModel(fname, threads, progress.get());
+          return std::move(*next);
+        });
+  }
+
+  /**
+   * @brief Проверяет фоновую загрузку, не блокируя поток.
+   * @return true, если загрузка завершилась и новая модель заменила текущую.
+   */
+  bool finishLoad() {
+    if (!isLoading() || loading_.wait_for(std::chrono::seconds(0)) !=
+                            std::future_status::ready)
+      return false;
+    Model next = loading_.get();
+    progress_.reset();
+    preview_.reset();
+    if (next.response == Response::Cancelled) return false;
+    stopReaders();
+    model_ = std::move(next);
+    queue_.clear();
+    clearHistory();
+    buildLodAsync();
+    saveCacheAsync();
+    return true;
+  }
+
+  /**
+   * @brief Отменяет фоновую загрузку; текущая модель не меняется.
+   *
+   * Не ждёт фоновый поток: тот заметит отмену на границе порции и
+   * завершится сам, а его future лежит в abandoned_.
+   */
+  void cancelLoad() {
+    std::erase_if(abandoned_, [](const std::future<Model> &loading) {
+      return loading.wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready;
+    });
+    if (!isLoading()) return;
+    progress_->cancelled = true;
+    abandoned_.push_back(std::move(loading_));
+    progress_.reset();
+    preview_.reset();
+  }
+
+  /**
+   * @brief Идёт ли фоновая загрузка.
+   */
+  bool isLoading() const { return loading_.valid(); }
+
+  /**
+   * @brief Проверяет фоновую сборку уровней детализации, не блокируя поток.
+   * @return true, если сборка завершилась и getLods() обновились.
+   *
+   * Сборка запускается после загрузки и после команд, менявших вершины;
+   * модель тем временем показывается целиком.
+   */
+  bool finishLod() {
+    if (!isBuildingLod() || lod_loading_.wait_for(std::chrono::seconds(0)) !=
+                                std::future_status::ready)
+      return false;
+    lods_ = lod_loading_.get();
+    return true;
+  }
+
+  /**
+   * @brief Идёт ли фоновая сборка уровней детализации.
+   */
+  bool isBuildingLod() const { return lod_loading_.valid(); }
+
+  /**
+   * @brief Уровни детализации текущей геометрии, от подробного к грубому
+   * (пусто, пока не собраны или если модель мала).
+   */
+  const Lod_levels &getLods() const { return lods_; }
+
+  /**
+   * @brief Прогресс фоновой загрузки (nullptr, если загрузки нет).
+   */
+  const Load_progress *loadProgress() const { return progress_.get(); }
+
+  /**
+   * @brief Уже разобранная часть загружаемой модели (nullptr, если загрузка
+   * идёт без постепенного показа).
+   */
+  Load_preview *loadPreview() { return preview_.get(); }
+
   /**
    * @brief Выполняет переданную команду, применяя её к модели.
    * @param cmd Уникальный указатель на объект команды, реализующий интерфейс
    * ICommand.
+   *
+   * Сначала выполняются команды, ждущие в очереди. Преобразования
+   * записываются в историю отмены (не больше kHistoryLimit), отменённые
+   * команды после этого повторить нельзя.
+   */
+  void executeCommand(std::unique_ptr<ICommand> cmd) {
+    flushCommands();
+    run(std::move(cmd));
+  }
+
+  /**
+   * @brief Ставит команду в очередь, объединяя её с предыдущей, если это
+   * возможно (см. ICommand::merge).
+   * @param cmd Команда.
+   *
+   * Очередь выполняется flushCommands(), например раз за кадр, поэтому
+   * серия нажатий превращается в одно преобразование и одно обновление
+   * экрана.
+   */
+  void enqueueCommand(std::unique_ptr<ICommand> cmd) {
+    if (!queue_.empty() && queue_.back()->merge(*cmd)) return;
+    queue_.push_back(std::move(cmd));
+  }
+
+  /**
+   * @brief Выполняет команды из очереди.
+   * @return false, если очередь была пуста.
+   */
+  bool flushCommands() {
+    if (queue_.empty()) return false;
+    std::vector<std::unique_ptr<ICommand>> queue = std::move(queue_);
+    queue_.clear();
+    for (auto &cmd : queue) run(std::move(cmd));
+    return true;
+  }
+
+  /**
+   * @brief Есть ли невыполненные команды в очереди.
+   */
+  bool hasPendingCommands() const { return !queue_.empty(); }
+
+  /**
+   * @brief Можно ли отменить последнюю команду.
+   */
+  bool canUndo() const {
+    return position_ > 0 &&
+           (replayable_ || !history_[position_ - 1].changes_geometry);
+  }
+
+  /**
+   * @brief Можно ли повторить отменённую команду.
+   */
+  bool canRedo() const { return position_ < history_.size(); }
+
+  /**
+   * @brief Отменяет последнюю выполненную команду.
+   * @return false, если отменять нечего.
+   *
+   * Команда, менявшая только transform, отменяется восстановлением
+   * матрицы. Команда, менявшая вершины (bake(), reset()), точно
+   * не обращается, поэтому состояние собирается заново: загруженная
+   * геометрия и повтор предыдущих команд истории.
+   */
+  bool undo() {
+    flushCommands();
+    if (!canUndo()) return false;
+    const History_entry &entry = history_[position_ - 1];
+    if (entry.changes_geometry)
+      replay(position_ - 1);
+    else
+      model_.transform = entry.before;
+    position_--;
+    return true;
+  }
+
+  /**
+   * @brief Повторяет последнюю отменённую команду.
+   * @return false, если повторять нечего.
+   */
+  bool redo() {
+    flushCommands();
+    if (!canRedo()) return false;
+    apply(*history_[position_++].command);
+    return true;
+  }
+
+  /**
+   * @brief Очищает историю отмены.
    */
-  void executeCommand(std::unique_ptr<ICommand> cmd) { cmd->execute(model_); }
+  void clearHistory() {
+    history_.clear();
+    position_ = 0;
+    replayable_ = true;
+  }
 
   /**
    * @brief Возвращает модель (только для чтения).
@@ -46,5 +475,27 @@ class Controller {
    * @brief Возвращает текущие полигоны модели.
    */
   const Polygons &getPolygons() const { return model_.polygons; }
+
+  /**
+   * @brief Возвращает уникальные рёбра модели.
+   */
+  const Edges &getEdges() const { return model_.edges; }
+
+  /**
+   * @brief Возвращает BVH модели.
+   */
+  const Mesh_bvh &getBvh() const { return model_.bvh; }
+
+  /**
+   * @brief Возвращает изменения геометрии с прошлого вызова и сбрасывает их.
+   *
+   * Нужен отрисовке, чтобы обновлять только изменённые участки буферов.
+   */
+  Mesh_changes takeChanges() { return model_.takeChanges(); }
+
+  /**
+   * @brief Возвращает накопленное преобразование модели.
+   */
+  const Matrix4 &getTransform() const { return model_.transform; }
 };
 }  // namespace s21
\ No newline at end of file
@@ -6,16 +6,46 @@
 #include "glwidget.h"
 
 #include <QDebug>
-#include <QMatrix4x4>
+#include <QSurfaceFormat>
 #include <QVector2D>
 #include <QVector3D>
 #include <QVector4D>
+#include <QtGlobal>
+#include <algorithm>
 #include <cmath>
-#include <set>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <utility>
 
+#include "shaders.h"
+
 namespace s21 {
 
+namespace {
+
+// Environment variable that forces the fixed-function renderer.
+constexpr char kLegacyVariable[] = "S21_GL_LEGACY";
+
+// Length of a dash and of the gap after it, in pixels.
+constexpr float kDashLength = 10.0f;
+constexpr float kGapLength = 5.0f;
+
+// Model matrix changes closer together than this count as rapid input.
+constexpr int kRapidInputMs = 150;
+// Full detail returns after the model has not moved for this long. Longer
+// than the auto-repeat interval of the step buttons, so holding one keeps
+// the proxy.
+constexpr int kIdleMs = 250;
+// Largest number of vertices drawn as the proxy of a mesh without levels.
+constexpr int kProxyPoints = 1 << 18;
+
+// A level of detail is drawn only if it has at least this many triangles
+// per pixel covered by the model; finer triangles are not visible anyway.
+constexpr double kLevelTrianglesPerPixel = 1.0;
+
+}  // namespace
+
 /**
  * @brief Constructs a GLWidget.
  * @param parent The parent widget.
@@ -23,11 +53,20 @@ namespace s21 {
 GLWidget::GLWidget(QWidget* parent)
     : QOpenGLWidget(parent),
       m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
-      m_indexBuffer(QOpenGLBuffer::IndexBuffer),
+      m_edgeBuffer(QOpenGLBuffer::IndexBuffer),
+      m_pointBuffer(QOpenGLBuffer::IndexBuffer),
       m_width(0),
       m_height(0),
       m_vertexCount(0),
-      m_indexCount(0) {}
+      m_proxyBuffer(QOpenGLBuffer::IndexBuffer) {
+  m_idleTimer.setSingleShot(true);
+  m_idleTimer.setInterval(kIdleMs);
+  connect(&m_idleTimer, &QTimer::timeout, this, [this]() {
+    m_moving = false;
+    m_rapid = false;
+    if (m_proxy) update();
+  });
+}
 
 /**
  * @brief Destroys the GLWidget and cleans up OpenGL resources.
@@ -35,36 +74,288 @@ GLWidget::GLWidget(QWidget* parent)
 GLWidget::~GLWidget() {
   makeCurrent();  // Ensure the context is current for cleanup
   m_vertexBuffer.destroy();
-  m_indexBuffer.destroy();
+  m_edgeBuffer.destroy();
+  m_pointBuffer.destroy();
+  m_proxyBuffer.destroy();
+  m_meshVao.destroy();
+  m_edgeVao.destroy();
+  m_pointVao.destroy();
+  m_proxyVao.destroy();
+  clearLevels();
+  m_meshProgram.reset();
+  m_lineProgram.reset();
+  m_pointProgram.reset();
   doneCurrent();
 }
 
 /**
- * @brief Sets the vertex data for the model.
- * @param vertices A vector of floats representing the vertex coordinates (x, y,
- * z).
+ * @brief Sets the default surface format before any widget is created.
+ *
+ * Requests an OpenGL 3.3 core profile context unless S21_GL_LEGACY is set.
+ * If the driver cannot provide one, Qt returns an older context and the
+ * widget falls back to the fixed-function renderer.
+ */
+void GLWidget::setDefaultFormat() {
+  if (qEnvironmentVariableIsSet(kLegacyVariable)) return;
+  QSurfaceFormat format = QSurfaceFormat::defaultFormat();
+  format.setVersion(3, 3);
+  format.setProfile(QSurfaceFormat::CoreProfile);
+  QSurfaceFormat::setDefaultFormat(format);
+}
+
+/**
+ * @brief Shows a mesh without copying it on the CPU.
+ * @param vertices Normalized vertex coordinates (x, y, z).
+ * @param edges Unique edges as index pairs.
  */
-void GLWidget::setVertexData(const std::vector<float>& vertices) {
+void GLWidget::setMesh(std::span<const float> vertices,
+                       std::span<const unsigned int> edges) {
+  m_appending = false;
+  m_vertexData = vertices;
+  m_vertexCount = vertices.size();
+  m_provisional = false;
+  m_edges = edges;
+  m_edgeCount = edges.size();
+  m_clusters = {};
+  m_points = {};
+  m_proxyDirty = true;
+
+  makeCurrent();
+  clearLevels();
+  writeBuffer(m_vertexBuffer, vertices.data(), vertices.size_bytes(),
+              m_vertexCapacity);
+  // The index buffer binding is part of the vertex array state
+  m_edgeVao.bind();
+  writeBuffer(m_edgeBuffer, edges.data(), edges.size_bytes(), m_edgeCapacity);
+  m_edgeVao.release();
+  doneCurrent();
+  update();
+}
+
+/**
+ * @brief Re-uploads a changed range of the shown vertices.
+ * @param vertices All vertex coordinates (x, y, z), possibly moved to a new
+ * array; the count must not change.
+ * @param first The first changed vertex.
+ * @param last The vertex after the last changed one.
+ * @return False if the widget shows a different mesh or the vertex count
+ * changed; the caller must then call setMesh().
+ */
+bool GLWidget::updateVertices(std::span<const float> vertices, size_t first,
+                              size_t last) {
+  if (m_appending || vertices.size() != m_vertexData.size())
+    return false;
+  m_vertexData = vertices;
+  if (first >= last) return true;
+  int offset = first * 3 * sizeof(float);
+  int bytes = (last - first) * 3 * sizeof(float);
   makeCurrent();
   m_vertexBuffer.bind();
-  m_vertexBuffer.allocate(vertices.data(), vertices.size() * sizeof(float));
-  m_vertexData = vertices;  // Store a copy for CPU access
-  m_vertexCount = vertices.size();
+  m_vertexBuffer.write(offset, vertices.data() + first * 3, bytes);
+  doneCurrent();
+  update();
+  return true;
+}
+
+/**
+ * @brief Sets the clusters used for frustum culling of the shown mesh.
+ * @param nodes The hierarchy over the mesh, root first.
+ * @param points Vertex indices grouped by its nodes; vertices of no
+ * cluster follow all of them and are always drawn.
+ */
+void GLWidget::setClusters(std::span<const Bvh_node> nodes,
+                           std::span<const unsigned int> points) {
+  m_clusters = nodes;
+  m_points = points;
+  makeCurrent();
+  m_pointVao.bind();
+  writeBuffer(m_pointBuffer, points.data(), points.size_bytes(),
+              m_pointCapacity);
+  m_pointVao.release();
+  doneCurrent();
+  update();
+}
+
+/**
+ * @brief Sets the levels of detail of the shown mesh.
+ * @param levels Levels from the finest to the coarsest.
+ */
+void GLWidget::setLevels(std::vector<Level> levels) {
+  makeCurrent();
+  clearLevels();
+  m_levels.resize(levels.size());
+  for (size_t i = 0; i < levels.size(); ++i) {
+    LevelBuffers& level = m_levels[i];
+    level.data = levels[i];
+    level.vertexBuffer.create();
+    level.vertexBuffer.bind();
+    level.vertexBuffer.allocate(level.data.vertices.data(),
+                                level.data.vertices.size_bytes());
+    if (m_core) {
+      level.vao = std::make_unique<QOpenGLVertexArrayObject>();
+      level.vao->create();
+      level.vao->bind();
+      level.vertexBuffer.bind();
+      glEnableVertexAttribArray(0);
+      glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
+    level.edgeBuffer.create();
+    level.edgeBuffer.bind();
+    level.edgeBuffer.allocate(level.data.edges.data(),
+                              level.data.edges.size_bytes());
+    if (level.vao) level.vao->release();
+  }
+  doneCurrent();
+  update();
+}
+
+/**
+ * @brief Releases the GPU buffers of the levels of detail.
+ *
+ * The context must be current.
+ */
+void GLWidget::clearLevels() {
+  for (LevelBuffers& level : m_levels) {
+    level.vertexBuffer.destroy();
+    level.edgeBuffer.destroy();
+    if (level.vao) level.vao->destroy();
+  }
+  m_levels.clear();
+  m_level = -1;
+}
+
+/**
+ * @brief Starts an empty mesh to be filled by the append functions.
+ *
+ * The buffers are allocated at the expected size up front, so the batches
+ * of a loading model are written in place with glBufferSubData() and no
+ * copy of them stays on the CPU.
+ * @param size The expected size of the whole model.
+ */
+void GLWidget::startAppending(const Preview_size& size) {
+  m_appending = true;
+  m_vertexData = {};
+  m_edges = {};
+  m_vertexCount = 0;
+  m_edgeCount = 0;
+  m_provisional = false;
+  m_clusters = {};
+  m_points = {};
+  m_proxyDirty = true;
+
+  auto reserve = [](QOpenGLBuffer& buffer, size_t bytes, int& capacity) {
+    capacity = static_cast<int>(
+        std::min<size_t>(bytes, std::numeric_limits<int>::max()));
+    buffer.bind();
+    buffer.allocate(capacity);
+  };
+  makeCurrent();
+  clearLevels();
+  reserve(m_vertexBuffer, size.vertices * 3 * sizeof(float),
+          m_vertexCapacity);
+  // Index buffer bindings are part of the vertex array state
+  m_edgeVao.bind();
+  reserve(m_edgeBuffer, size.edges * sizeof(unsigned int), m_edgeCapacity);
+  m_edgeVao.release();
+  doneCurrent();
+  update();
+}
+
+/**
+ * @brief Appends vertices to the end of the vertex buffer.
+ * @param vertices New vertex coordinates (x, y, z).
+ */
+void GLWidget::appendVertexData(std::span<const float> vertices) {
+  if (vertices.empty()) return;
+  makeCurrent();
+  appendToBuffer(m_vertexBuffer, m_vertexCount * sizeof(float),
+                 vertices.data(), vertices.size_bytes(), m_vertexCapacity);
   doneCurrent();
+  m_vertexCount += vertices.size();
+  m_proxyDirty = true;
 }
 
 /**
- * @brief Sets the index data for the model.
- * @param indices A vector of unsigned integers representing the indices of the
- * vertices that form the faces of the model.
+ * @brief Appends edges to the end of the edge buffer.
+ * @param edges New edges as index pairs.
  */
-void GLWidget::setIndexData(const std::vector<unsigned int>& indices) {
+void GLWidget::appendEdgeData(std::span<const unsigned int> edges) {
+  if (edges.empty()) return;
   makeCurrent();
-  m_indexBuffer.bind();
-  m_indexBuffer.allocate(indices.data(), indices.size() * sizeof(unsigned int));
-  m_indexCount = indices.size();
-  m_originalIndices = indices;  // Keep a copy on the CPU
+  m_edgeVao.bind();
+  appendToBuffer(m_edgeBuffer, m_edgeCount * sizeof(unsigned int),
+                 edges.data(), edges.size_bytes(), m_edgeCapacity);
+  m_edgeVao.release();
   doneCurrent();
+  m_edgeCount += edges.size();
+  update();
+}
+
+/**
+ * @brief Writes a range after the used part of a GPU buffer.
+ *
+ * The range goes straight into the buffer with glBufferSubData(). If the
+ * buffer is full, which only happens when the size estimate was too low,
+ * the used part is read back and moved to a buffer twice as large.
+ */
+void GLWidget::appendToBuffer(QOpenGLBuffer& buffer, int used,
+                              const void* data, int bytes, int& capacity) {
+  buffer.bind();
+  if (used + bytes > capacity) {
+    std::vector<char> contents(used);
+    if (used > 0) buffer.read(0, contents.data(), used);
+    capacity = static_cast<int>(std::min<qint64>(
+        2 * (static_cast<qint64>(used) + bytes),
+        std::numeric_limits<int>::max()));
+    buffer.allocate(capacity);
+    if (used > 0) buffer.write(0, contents.data(), used);
+  }
+  buffer.write(used, data, bytes);
+}
+
+/**
+ * @brief Replaces the contents of a GPU buffer.
+ *
+ * Storage of a fitting size is reused and only overwritten, so showing a
+ * mesh of the same size does not reallocate; a much smaller mesh gets a
+ * new, smaller buffer.
+ */
+void GLWidget::writeBuffer(QOpenGLBuffer& buffer, const void* data, int bytes,
+                           int& capacity) {
+  buffer.bind();
+  if (bytes <= capacity && bytes >= capacity / 2) {
+    if (bytes > 0) buffer.write(0, data, bytes);
+  } else {
+    buffer.allocate(data, bytes);
+    capacity = bytes;
+  }
+}
+
+/**
+ * @brief Sets the model matrix applied to the vertices at draw time.
+ * @param matrix The model transform.
+ */
+void GLWidget::setModelMatrix(const QMatrix4x4& matrix) {
+  if (matrix != m_modelMatrix) {
+    m_rapid = m_moving && m_sinceMove.elapsed() < kRapidInputMs;
+    m_moving = true;
+    m_sinceMove.start();
+    m_idleTimer.start();
+  }
+  m_modelMatrix = matrix;
+  update();
+}
+
+/**
+ * @brief Sets a normalization applied at draw time.
+ * @param center The center of the loaded part.
+ * @param scale The divisor that fits the loaded part into the view.
+ */
+void GLWidget::setProvisionalNormalization(const QVector3D& center,
+                                           float scale) {
+  m_provisional = true;
+  m_provisionalCenter = center;
+  m_provisionalScale = scale;
   update();
 }
 
@@ -105,7 +396,89 @@ void GLWidget::initializeGL() {
 
   // Create Vertex and Index Buffer Objects
   m_vertexBuffer.create();
-  m_indexBuffer.create();
+  m_edgeBuffer.create();
+  m_pointBuffer.create();
+  m_proxyBuffer.create();
+
+  m_core = !qEnvironmentVariableIsSet(kLegacyVariable) && initializeCore();
+  emit rendererChanged(m_core ? "OpenGL 3.3 core" : "fixed-function");
+}
+
+/**
+ * @brief Builds the shader programs and vertex arrays of the core renderer.
+ * @return False if the context is older than OpenGL 3.3 or a program does
+ * not link; the widget then uses the fixed-function renderer.
+ */
+bool GLWidget::initializeCore() {
+  QSurfaceFormat format = context()->format();
+  if (context()->isOpenGLES() || format.version() < qMakePair(3, 3))
+    return false;
+
+  auto build = [](const char* vertex, const char* geometry,
+                  const char* fragment) {
+    auto program = std::make_unique<QOpenGLShaderProgram>();
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertex) ||
+        (geometry && !program->addShaderFromSourceCode(
+                         QOpenGLShader::Geometry, geometry)) ||
+        !program->addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                          fragment) ||
+        !program->link()) {
+      qWarning() << "GLWidget:" << program->log();
+      program.reset();
+    }
+    return program;
+  };
+  using namespace shaders;
+  m_meshProgram = build(kMeshVertexShader, nullptr, kColorFragmentShader);
+  m_lineProgram =
+      build(kMeshVertexShader, kLineGeometryShader, kLineFragmentShader);
+  m_pointProgram =
+      build(kPointVertexShader, nullptr, kPointFragmentShader);
+  if (!m_meshProgram || !m_lineProgram || !m_pointProgram ||
+      !m_meshVao.create() || !m_edgeVao.create() || !m_pointVao.create() ||
+      !m_proxyVao.create()) {
+    m_meshProgram.reset();
+    m_lineProgram.reset();
+    m_pointProgram.reset();
+    m_meshVao.destroy();
+    m_edgeVao.destroy();
+    m_pointVao.destroy();
+    m_proxyVao.destroy();
+    return false;
+  }
+
+  // The model buffers keep their names when reallocated, so the vertex
+  // array is set up once
+  m_meshVao.bind();
+  m_vertexBuffer.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  m_meshVao.release();
+
+  m_edgeVao.bind();
+  m_vertexBuffer.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  m_edgeBuffer.bind();
+  m_edgeVao.release();
+
+  m_pointVao.bind();
+  m_vertexBuffer.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  m_pointBuffer.bind();
+  m_pointVao.release();
+
+  m_proxyVao.bind();
+  m_vertexBuffer.bind();
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  m_proxyBuffer.bind();
+  m_proxyVao.release();
+
+  // Point sprites take their size from the vertex shader
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  return true;
 }
 
 /**
@@ -119,57 +492,444 @@ void GLWidget::resizeGL(int w, int h) {
   glViewport(0, 0, w, h);
 }
 
+/**
+ * @brief Gets the projection matrix for the current projection type.
+ */
+QMatrix4x4 GLWidget::projectionMatrix() const {
+  QMatrix4x4 projection;
+  float aspect = static_cast<float>(m_width) /
+                 static_cast<float>(m_height > 0 ? m_height : 1);
+  if (m_options.projectionType == s21::ProjectionType::Orthographic) {
+    float ortho_size = 1.0f;
+    projection.ortho(-ortho_size * aspect, ortho_size * aspect, -ortho_size,
+                     ortho_size, -100.0f, 100.0f);
+  } else {
+    constexpr float near_plane = 1.0f, far_plane = 100.0f;
+    constexpr double fovY = 45.0;
+    float top = tan(fovY * M_PI / 360.0) * near_plane;
+    float right = top * aspect;
+    projection.frustum(-right, right, -top, top, near_plane, far_plane);
+  }
+  return projection;
+}
+
+/**
+ * @brief Gets the view matrix, which moves the camera back.
+ */
+QMatrix4x4 GLWidget::viewMatrix() const {
+  QMatrix4x4 view;
+  view.translate(0, 0, -5.0f);
+  return view;
+}
+
+/**
+ * @brief Gets the model matrix, including any provisional normalization.
+ */
+QMatrix4x4 GLWidget::modelMatrix() const {
+  QMatrix4x4 model = m_modelMatrix;
+  if (m_provisional) {
+    model.scale(1.0f / m_provisionalScale);
+    model.translate(-m_provisionalCenter);
+  }
+  return model;
+}
+
 /**
  * @brief Renders the 3D model.
  */
 void GLWidget::paintGL() {
+  QElapsedTimer frameTimer;
+  frameTimer.start();
   // Set the background color
   glClearColor(m_options.backgroundColor.redF(),
                m_options.backgroundColor.greenF(),
                m_options.backgroundColor.blueF(), 1.0f);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  // Set up the projection matrix
-  glMatrixMode(GL_PROJECTION);
-  glLoadIdentity();
+  QMatrix4x4 mvp = projectionMatrix() * viewMatrix() * modelMatrix();
+  bool proxy = useProxy();
+  // The coarsest level is the proxy; without levels a subset of the
+  // vertices is drawn instead
+  int level = selectLevel(mvp);
+  if (proxy && !m_levels.empty()) level = static_cast<int>(m_levels.size()) - 1;
+  if (level != m_level || proxy != m_proxy) {
+    m_level = level;
+    m_proxy = proxy;
+    emit detailChanged(level, proxy);
+  }
+  if (m_proxy && m_levels.empty()) updateProxyPoints();
+  cullClusters(mvp);
+  if (m_core)
+    paintCore();
+  else
+    paintLegacy();
+  // Only the CPU side and whatever the driver blocks on are measured; a
+  // frame the GPU is slow with shows up as a stall in the frames after it
+  if (!m_proxy) m_fullFrameTime = frameTimer.nsecsElapsed() / 1e6;
+}
 
-  float aspect = static_cast<float>(m_width) /
-                 static_cast<float>(m_height > 0 ? m_height : 1);
-  if (m_options.projectionType == s21::ProjectionType::Orthographic) {
-    float ortho_size = 1.0f;
-    glOrtho(-ortho_size * aspect, ortho_size * aspect, -ortho_size, ortho_size,
-            -100.0, 100.0);
+/**
+ * @brief Decides whether the current frame draws a proxy.
+ *
+ * The proxy is drawn while the model is being moved, if the moves come in
+ * quick succession or the last full frame took longer than the frame
+ * budget. Small meshes have no proxy: they are drawn in full anyway.
+ */
+bool GLWidget::useProxy() const {
+  if (m_options.frameBudget <= 0 || !m_moving) return false;
+  if (m_levels.empty() && m_vertexCount / 3 <= kProxyPoints) return false;
+  return m_rapid || m_fullFrameTime > m_options.frameBudget;
+}
+
+/**
+ * @brief Uploads every n-th vertex, at most kProxyPoints of them, as the
+ * proxy of a mesh without levels of detail.
+ */
+void GLWidget::updateProxyPoints() {
+  if (!m_proxyDirty) return;
+  m_proxyDirty = false;
+  int count = m_vertexCount / 3;
+  int step = std::max(1, (count + kProxyPoints - 1) / kProxyPoints);
+  std::vector<unsigned int> indices;
+  indices.reserve(count / step + 1);
+  for (int v = 0; v < count; v += step) indices.push_back(v);
+  m_proxyCount = indices.size();
+  // The index buffer binding is part of the vertex array state
+  m_proxyVao.bind();
+  writeBuffer(m_proxyBuffer, indices.data(),
+              static_cast<int>(indices.size() * sizeof(unsigned int)),
+              m_proxyCapacity);
+  m_proxyVao.release();
+}
+
+/**
+ * @brief Collects the edge and point ranges of the clusters in view.
+ *
+ * Walks the hierarchy from the root: a node whose box is entirely beyond
+ * one clip plane is skipped with all its children, a node entirely inside
+ * is taken whole, and only boxes crossing the frustum boundary are split
+ * further. Nodes are visited in the order of their ranges, so adjacent
+ * visible clusters merge into one draw call. The test allows for the size
+ * of the drawn lines and points, so they do not vanish at the border.
+ * @param mvp The full model-view-projection matrix.
+ */
+void GLWidget::cullClusters(const QMatrix4x4& mvp) {
+  m_edgeRanges.clear();
+  m_pointRanges.clear();
+  int culled = 0;
+  if (!culling()) {
+    m_edgeRanges.emplace_back(
+        0, m_level < 0 ? m_edgeCount : shownEdges().size());
   } else {
-    constexpr double near_plane = 1.0, far_plane = 100.0;
-    constexpr double fovY = 45.0;
-    double top = tan(fovY * M_PI / 360.0) * near_plane;
-    double right = top * aspect;
-    glFrustum(-right, right, -top, top, near_plane, far_plane);
+    auto add = [](std::vector<std::pair<int, int>>& ranges, int first,
+                  int count) {
+      if (count == 0) return;
+      if (!ranges.empty() &&
+          ranges.back().first + ranges.back().second == first)
+        ranges.back().second += count;
+      else
+        ranges.emplace_back(first, count);
+    };
+    // Edges and points reach past the box of their triangles: thick lines
+    // and square points by half their size in pixels, which widens the
+    // side planes, and circles by their radius in model units, which grows
+    // the box
+    float pixels = m_options.lineThickness;
+    if (m_options.pointType == PointType::Square)
+      pixels = std::max(pixels, static_cast<float>(m_options.pointSize));
+    float sideX = 1.0f + pixels / std::max(m_width, 1);
+    float sideY = 1.0f + pixels / std::max(m_height, 1);
+    float radius =
+        m_options.pointType == PointType::Circle ? circleRadius() : 0.0f;
+    // -1 if the box is outside the clip volume, 1 if inside, 0 if crossing
+    auto classify = [&](const Bvh_node& node) {
+      int beyond[6] = {};
+      for (int c = 0; c < 8; ++c) {
+        QVector4D p = mvp * QVector4D(c & 1 ? node.max.x + radius
+                                            : node.min.x - radius,
+                                      c & 2 ? node.max.y + radius
+                                            : node.min.y - radius,
+                                      c & 4 ? node.max.z + radius
+                                            : node.min.z - radius,
+                                      1.0f);
+        beyond[0] += p.x() < -p.w() * sideX;
+        beyond[1] += p.x() > p.w() * sideX;
+        beyond[2] += p.y() < -p.w() * sideY;
+        beyond[3] += p.y() > p.w() * sideY;
+        beyond[4] += p.z() < -p.w();
+        beyond[5] += p.z() > p.w();
+      }
+      if (std::find(beyond, beyond + 6, 8) != beyond + 6) return -1;
+      return std::count(beyond, beyond + 6, 0) == 6 ? 1 : 0;
+    };
+
+    int64_t visible = 0;
+    std::vector<int> stack{0};
+    while (!stack.empty()) {
+      const Bvh_node& node = m_clusters[stack.back()];
+      stack.pop_back();
+      int side = classify(node);
+      if (side < 0) continue;
+      if (side == 0 && !node.leaf()) {
+        stack.push_back(node.right);
+        stack.push_back(node.left);
+        continue;
+      }
+      add(m_edgeRanges, node.edges_from * 2,
+          (node.edges_to - node.edges_from) * 2);
+      add(m_pointRanges, node.points_from, node.points_to - node.points_from);
+      visible += node.triangles_to - node.triangles_from;
+    }
+    // Vertices of no triangle are not in any cluster
+    const Bvh_node& root = m_clusters.front();
+    add(m_pointRanges, root.points_to, m_points.size() - root.points_to);
+    if (root.triangles_to > 0)
+      culled = (root.triangles_to - visible) * 100 / root.triangles_to;
+  }
+  if (culled != m_culledPercent) {
+    m_culledPercent = culled;
+    emit culledChanged(culled);
+  }
+}
+
+/**
+ * @brief Picks the level of detail for the model's size on screen.
+ *
+ * The model's bounding box is projected to the window, and the coarsest
+ * level that still has kLevelTrianglesPerPixel triangles per pixel of its
+ * visible part is drawn. The full mesh is drawn if no level is fine enough
+ * or the box reaches behind the camera.
+ */
+int GLWidget::selectLevel(const QMatrix4x4& mvp) const {
+  if (m_levels.empty() || m_clusters.empty()) return -1;
+  const Bvh_node& root = m_clusters.front();
+  float left = 1.0f, right = -1.0f, bottom = 1.0f, top = -1.0f;
+  for (int c = 0; c < 8; ++c) {
+    QVector4D p = mvp * QVector4D(c & 1 ? root.max.x : root.min.x,
+                                  c & 2 ? root.max.y : root.min.y,
+                                  c & 4 ? root.max.z : root.min.z, 1.0f);
+    if (p.w() <= 0.0f) return -1;
+    left = std::min(left, p.x() / p.w());
+    right = std::max(right, p.x() / p.w());
+    bottom = std::min(bottom, p.y() / p.w());
+    top = std::max(top, p.y() / p.w());
+  }
+  // Only the part inside the window needs detail
+  double width = (std::min(right, 1.0f) - std::max(left, -1.0f)) / 2 * m_width;
+  double height =
+      (std::min(top, 1.0f) - std::max(bottom, -1.0f)) / 2 * m_height;
+  double pixels = std::max(width, 0.0) * std::max(height, 0.0);
+  for (int i = static_cast<int>(m_levels.size()) - 1; i >= 0; --i)
+    if (m_levels[i].data.triangles >= pixels * kLevelTrianglesPerPixel)
+      return i;
+  return -1;
+}
+
+/**
+ * @brief Gets the vertices drawn this frame: the mesh or the chosen level.
+ */
+std::span<const float> GLWidget::shownVertices() const {
+  return m_level < 0 ? m_vertexData : m_levels[m_level].data.vertices;
+}
+
+/**
+ * @brief Gets the edges drawn this frame: the mesh or the chosen level.
+ */
+std::span<const unsigned int> GLWidget::shownEdges() const {
+  return m_level < 0 ? m_edges : m_levels[m_level].data.edges;
+}
+
+/**
+ * @brief Draws the given ranges of the bound index buffer.
+ * @param mode The primitive type.
+ * @param ranges (first, count) ranges of indices.
+ */
+void GLWidget::drawRanges(GLenum mode,
+                          const std::vector<std::pair<int, int>>& ranges) {
+  for (const auto& [first, count] : ranges)
+    glDrawElements(mode, count, GL_UNSIGNED_INT,
+                   reinterpret_cast<const void*>(first * sizeof(GLuint)));
+}
+
+/**
+ * @brief Renders the model with shader programs and vertex arrays.
+ *
+ * Draws the same picture as paintLegacy(); the matrices are passed to the
+ * program as uniforms.
+ */
+void GLWidget::paintCore() {
+  if (m_vertexCount == 0) return;
+
+  QMatrix4x4 projection = projectionMatrix();
+  QMatrix4x4 view = viewMatrix();
+  QMatrix4x4 model = modelMatrix();
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  if (m_proxy && m_levels.empty()) {
+    // A subset of the vertices stands in for the moving mesh
+    m_pointProgram->bind();
+    m_pointProgram->setUniformValue("projection", projection);
+    m_pointProgram->setUniformValue("view", view);
+    m_pointProgram->setUniformValue("model", model);
+    m_pointProgram->setUniformValue("color", m_options.color);
+    m_pointProgram->setUniformValue("size", 1.0f);
+    m_pointProgram->setUniformValue("radius", 0.0f);
+    m_pointProgram->setUniformValue("viewportHeight",
+                                    static_cast<float>(viewport[3]));
+    m_pointProgram->setUniformValue("round", false);
+    m_proxyVao.bind();
+    glDrawElements(GL_POINTS, m_proxyCount, GL_UNSIGNED_INT, nullptr);
+    m_proxyVao.release();
+    m_pointProgram->release();
+    return;
+  }
+  m_meshProgram->bind();
+  m_meshProgram->setUniformValue("projection", projection);
+  m_meshProgram->setUniformValue("view", view);
+  m_meshProgram->setUniformValue("model", model);
+  m_meshVao.bind();
+  // A level of detail keeps its vertices and edges in one vertex array
+  QOpenGLVertexArrayObject& edgeVao =
+      m_level < 0 ? m_edgeVao : *m_levels[m_level].vao;
+
+  // Draw edges
+  if (m_options.lineThickness > 0) {
+    if (m_options.lineThickness == 1 && m_options.lineType == LineType::Solid) {
+      // Each shared edge is drawn once
+      m_meshProgram->setUniformValue("color", m_options.color);
+      edgeVao.bind();
+      drawRanges(GL_LINES, m_edgeRanges);
+      m_meshVao.bind();
+    } else {
+      // Each unique edge is expanded into a quad by the geometry shader
+      m_lineProgram->bind();
+      m_lineProgram->setUniformValue("projection", projection);
+      m_lineProgram->setUniformValue("view", view);
+      m_lineProgram->setUniformValue("model", model);
+      m_lineProgram->setUniformValue("viewport",
+                                     QVector2D(viewport[2], viewport[3]));
+      m_lineProgram->setUniformValue(
+          "thickness", static_cast<float>(m_options.lineThickness));
+      m_lineProgram->setUniformValue("color", m_options.color);
+      m_lineProgram->setUniformValue(
+          "dashed", m_options.lineType == s21::LineType::Dashed);
+      m_lineProgram->setUniformValue("dash", kDashLength);
+      m_lineProgram->setUniformValue("gap", kGapLength);
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+      glDisable(GL_DEPTH_TEST);
+      glDisable(GL_CULL_FACE);
+      edgeVao.bind();
+      drawRanges(GL_LINES, m_edgeRanges);
+      glEnable(GL_CULL_FACE);
+      glEnable(GL_DEPTH_TEST);
+      m_meshProgram->bind();
+      m_meshVao.bind();
+    }
+  }
+
+  // Draw vertices, each once, straight from the vertex buffer
+  if (m_options.pointType != s21::PointType::None) {
+    bool circle = m_options.pointType == s21::PointType::Circle;
+    m_pointProgram->bind();
+    m_pointProgram->setUniformValue("projection", projection);
+    m_pointProgram->setUniformValue("view", view);
+    m_pointProgram->setUniformValue("model", model);
+    m_pointProgram->setUniformValue("color", m_options.pointColor);
+    m_pointProgram->setUniformValue(
+        "size", static_cast<float>(m_options.pointSize));
+    m_pointProgram->setUniformValue("radius",
+                                    circle ? circleRadius() : 0.0f);
+    m_pointProgram->setUniformValue("viewportHeight",
+                                    static_cast<float>(viewport[3]));
+    m_pointProgram->setUniformValue("round", circle);
+    if (m_level >= 0) {
+      edgeVao.bind();
+      glDrawArrays(GL_POINTS, 0, shownVertices().size() / 3);
+    } else if (!culling()) {
+      glDrawArrays(GL_POINTS, 0, m_vertexCount / 3);
+    } else {
+      m_pointVao.bind();
+      drawRanges(GL_POINTS, m_pointRanges);
+    }
   }
 
-  // Set up the model-view matrix
+  m_meshVao.release();
+  m_meshProgram->release();
+}
+
+/**
+ * @brief Renders the model with the fixed-function pipeline.
+ *
+ * Used when the context does not support OpenGL 3.3 or when S21_GL_LEGACY
+ * is set. Thick and dashed lines and circles are built from the vertices on
+ * the CPU, so a model that is still being appended, of which only the GPU
+ * holds a copy, is drawn with thin lines and square points until setMesh().
+ */
+void GLWidget::paintLegacy() {
+  QMatrix4x4 projection = projectionMatrix();
+  QMatrix4x4 modelview = viewMatrix() * modelMatrix();
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  glMatrixMode(GL_PROJECTION);
+  glLoadMatrixf(projection.constData());
   glMatrixMode(GL_MODELVIEW);
-  glLoadIdentity();
-  glTranslatef(0, 0, -5.0);  // Move the camera back
+  glLoadMatrixf(modelview.constData());
 
-  if (m_indexCount == 0) return;
+  if (m_vertexCount == 0) return;
 
   glEnableClientState(GL_VERTEX_ARRAY);
-  m_vertexBuffer.bind();
+  QOpenGLBuffer& vertexBuffer =
+      m_level < 0 ? m_vertexBuffer : m_levels[m_level].vertexBuffer;
+  QOpenGLBuffer& edgeBuffer =
+      m_level < 0 ? m_edgeBuffer : m_levels[m_level].edgeBuffer;
+  vertexBuffer.bind();
   glVertexPointer(3, GL_FLOAT, 0, nullptr);
-  m_indexBuffer.bind();
+  if (m_proxy && m_levels.empty()) {
+    // A subset of the vertices stands in for the moving mesh
+    glColor3f(m_options.color.redF(), m_options.color.greenF(),
+              m_options.color.blueF());
+    glPointSize(1.0f);
+    m_proxyBuffer.bind();
+    glDrawElements(GL_POINTS, m_proxyCount, GL_UNSIGNED_INT, nullptr);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    return;
+  }
 
   // Draw edges
   if (m_options.lineThickness > 0) {
-    if (m_options.lineThickness == 1 && m_options.lineType == LineType::Solid) {
-      glDisable(GL_CULL_FACE);
+    bool thin =
+        m_options.lineThickness == 1 && m_options.lineType == LineType::Solid;
+    if (thin || m_appending) {
       glColor3f(m_options.color.redF(), m_options.color.greenF(),
                 m_options.color.blueF());
-      glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-      glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
-      glEnable(GL_CULL_FACE);
+      edgeBuffer.bind();
+      drawRanges(GL_LINES, m_edgeRanges);
     } else {
-      drawThickLines();
+      std::vector<QVector2D> quads =
+          thickLineTriangles(projection * modelview, viewport);
+      // Set up 2D orthographic projection for drawing lines
+      glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+      glMatrixMode(GL_PROJECTION);
+      glPushMatrix();
+      glLoadIdentity();
+      glOrtho(0, viewport[2], 0, viewport[3], -1, 1);
+      glMatrixMode(GL_MODELVIEW);
+      glPushMatrix();
+      glLoadIdentity();
+      glDisable(GL_DEPTH_TEST);
+
+      glColor3f(m_options.color.redF(), m_options.color.greenF(),
+                m_options.color.blueF());
+      glBegin(GL_TRIANGLES);
+      for (const QVector2D& p : quads) glVertex2f(p.x(), p.y());
+      glEnd();
+
+      // Restore OpenGL state
+      glEnable(GL_DEPTH_TEST);
+      glMatrixMode(GL_PROJECTION);
+      glPopMatrix();
+      glMatrixMode(GL_MODELVIEW);
+      glPopMatrix();
     }
   }
 
@@ -180,24 +940,16 @@ void GLWidget::paintGL() {
               m_options.pointColor.blueF());
     glPointSize(m_options.pointSize);
 
-    if (m_options.pointType == s21::PointType::Circle) {
-      float r = m_options.pointSize * 0.0025f;
-      for (int i = 0; i < m_vertexCount / 3; ++i) {
-        float x = m_vertexData[i * 3 + 0];
-        float y = m_vertexData[i * 3 + 1];
-        float z = m_vertexData[i * 3 + 2];
-        glBegin(GL_TRIANGLE_FAN);
-        glColor3f(m_options.pointColor.redF(), m_options.pointColor.greenF(),
-                  m_options.pointColor.blueF());
-        glVertex3f(x, y, z);
-        for (int j = 0; j <= 20; ++j) {
-          float angle = j * 2.0f * M_PI / 20;
-          glVertex3f(x + cos(angle) * r, y + sin(angle) * r, z);
-        }
-        glEnd();
-      }
-    } else {  // Square points
-      glDrawElements(GL_POINTS, m_indexCount, GL_UNSIGNED_INT, nullptr);
+    if (m_options.pointType == s21::PointType::Circle && !m_appending) {
+      drawCircles();
+    } else if (!culling()) {  // Square points, each vertex once
+      // An appended model is only on the GPU, so m_vertexData is empty
+      glDrawArrays(GL_POINTS, 0,
+                   m_level < 0 ? m_vertexCount / 3
+                               : shownVertices().size() / 3);
+    } else {
+      m_pointBuffer.bind();
+      drawRanges(GL_POINTS, m_pointRanges);
     }
   }
 
@@ -205,36 +957,68 @@ void GLWidget::paintGL() {
 }
 
 /**
- * @brief Draws thick or dashed lines for the edges of the model.
- *
- * This function manually projects, clips, and renders each edge as a quad to
- * control its thickness and style.
+ * @brief Gets the radius of circle points in model units.
  */
-void GLWidget::drawThickLines() {
-  if (m_vertexData.empty() || m_originalIndices.empty()) return;
-
-  glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+float GLWidget::circleRadius() const {
+  float r = m_options.pointSize * 0.0025f;
+  if (m_provisional) r *= m_provisionalScale;
+  return r;
+}
 
-  GLfloat modelview[16];
-  GLfloat projection[16];
-  GLint viewport[4];
-  glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
-  glGetFloatv(GL_PROJECTION_MATRIX, projection);
-  glGetIntegerv(GL_VIEWPORT, viewport);
+/**
+ * @brief Draws filled circles around the vertices, in model coordinates.
+ *
+ * Used by the fixed-function renderer; the core renderer draws circles as
+ * point sprites. The triangles are streamed in one glBegin()/glEnd() pair
+ * rather than collected first: a cloud of millions of points would need
+ * gigabytes for them.
+ */
+void GLWidget::drawCircles() {
+  constexpr int segments = 20;
+  float r = circleRadius();
+  QVector3D rim[segments + 1];
+  for (int j = 0; j <= segments; ++j) {
+    float angle = j * 2.0f * M_PI / segments;
+    rim[j] = QVector3D(cos(angle) * r, sin(angle) * r, 0.0f);
+  }
 
-  // Lambda to project a 3D object point to 4D clip coordinates
-  auto projectToClip = [&](const QVector3D& obj, QVector4D& clip) {
-    QVector4D in(obj.x(), obj.y(), obj.z(), 1.0f);
-    auto multiply = [](const GLfloat m[16], const QVector4D& v) -> QVector4D {
-      return QVector4D(
-          m[0] * v.x() + m[4] * v.y() + m[8] * v.z() + m[12] * v.w(),
-          m[1] * v.x() + m[5] * v.y() + m[9] * v.z() + m[13] * v.w(),
-          m[2] * v.x() + m[6] * v.y() + m[10] * v.z() + m[14] * v.w(),
-          m[3] * v.x() + m[7] * v.y() + m[11] * v.z() + m[15] * v.w());
-    };
-    QVector4D eye = multiply(modelview, in);
-    clip = multiply(projection, eye);
+  std::span<const float> vertices = shownVertices();
+  auto drawCircle = [&](size_t v) {
+    QVector3D center(vertices[v * 3], vertices[v * 3 + 1],
+                     vertices[v * 3 + 2]);
+    for (int j = 0; j < segments; ++j) {
+      QVector3D a = center + rim[j], b = center + rim[j + 1];
+      glVertex3f(center.x(), center.y(), center.z());
+      glVertex3f(a.x(), a.y(), a.z());
+      glVertex3f(b.x(), b.y(), b.z());
+    }
   };
+  glBegin(GL_TRIANGLES);
+  if (!culling()) {
+    for (size_t v = 0; v < vertices.size() / 3; ++v) drawCircle(v);
+  } else {  // Only the vertices of clusters in view
+    for (const auto& [first, count] : m_pointRanges)
+      for (int p = first; p < first + count; ++p) drawCircle(m_points[p]);
+  }
+  glEnd();
+}
+
+/**
+ * @brief Builds thick or dashed lines for the edges of the model.
+ *
+ * Used by the fixed-function renderer: projects and clips each unique edge
+ * on the CPU and turns it into a quad of the requested thickness and style.
+ * The core renderer does the same in shaders::kLineGeometryShader.
+ * @param mvp The full model-view-projection matrix.
+ * @param viewport The viewport the lines are drawn into.
+ * @return Triangles in window coordinates, two per quad.
+ */
+std::vector<QVector2D> GLWidget::thickLineTriangles(
+    const QMatrix4x4& mvp, const GLint viewport[4]) const {
+  std::vector<QVector2D> triangles;
+  std::span<const float> vertices = shownVertices();
+  std::span<const unsigned int> edges = shownEdges();
+  if (vertices.empty() || edges.empty()) return triangles;
 
   // Sutherland-Hodgman-like clipping for a line in 4D homogeneous coordinates
   auto clipLine = [](QVector4D& p1, QVector4D& p2) -> bool {
@@ -297,44 +1081,24 @@ void GLWidget::drawThickLines() {
     return false;  // Should not be reached if clipping is successful
   };
 
-  // Set up 2D orthographic projection for drawing lines
-  glMatrixMode(GL_PROJECTION);
-  glPushMatrix();
-  glLoadIdentity();
-  glOrtho(0, m_width, 0, m_height, -1, 1);
-  glMatrixMode(GL_MODELVIEW);
-  glPushMatrix();
-  glLoadIdentity();
-  glDisable(GL_DEPTH_TEST);
+  // Two triangles covering the quad a+perp, a-perp, b-perp, b+perp
+  auto addQuad = [&](QVector2D a, QVector2D b, QVector2D perp) {
+    triangles.insert(triangles.end(), {a + perp, a - perp, b - perp, a + perp,
+                                       b - perp, b + perp});
+  };
 
-  glColor3f(m_options.color.redF(), m_options.color.greenF(),
-            m_options.color.blueF());
   float thickness = m_options.lineThickness;
+  for (const auto& [first, count] : m_edgeRanges) {
+    for (int e = first; e + 1 < first + count; e += 2) {
+      unsigned int i1 = edges[e];
+      unsigned int i2 = edges[e + 1];
 
-  glBegin(GL_QUADS);
-
-  std::set<std::pair<unsigned int, unsigned int>> drawn_edges;
-
-  for (size_t i = 0; i < m_originalIndices.size(); i += 3) {
-    unsigned int indices[3] = {m_originalIndices[i], m_originalIndices[i + 1],
-                               m_originalIndices[i + 2]};
-
-    for (int j = 0; j < 3; ++j) {
-      unsigned int i1 = indices[j];
-      unsigned int i2 = indices[(j + 1) % 3];
-
-      if (i1 > i2) std::swap(i1, i2);
-      if (drawn_edges.count({i1, i2})) continue;
-      drawn_edges.insert({i1, i2});
-
-      QVector3D p1_world(m_vertexData[i1 * 3], m_vertexData[i1 * 3 + 1],
-                         m_vertexData[i1 * 3 + 2]);
-      QVector3D p2_world(m_vertexData[i2 * 3], m_vertexData[i2 * 3 + 1],
-                         m_vertexData[i2 * 3 + 2]);
-
-      QVector4D p1_clip, p2_clip;
-      projectToClip(p1_world, p1_clip);
-      projectToClip(p2_world, p2_clip);
+      QVector4D p1_clip = mvp * QVector4D(vertices[i1 * 3],
+                                          vertices[i1 * 3 + 1],
+                                          vertices[i1 * 3 + 2], 1.0f);
+      QVector4D p2_clip = mvp * QVector4D(vertices[i2 * 3],
+                                          vertices[i2 * 3 + 1],
+                                          vertices[i2 * 3 + 2], 1.0f);
 
       if (!clipLine(p1_clip, p2_clip)) continue;
 
@@ -361,45 +1125,29 @@ void GLWidget::drawThickLines() {
       perp *= thickness / 2.0f;
 
       if (m_options.lineType == s21::LineType::Dashed) {
-        constexpr float dash_length = 10.0f;
-        constexpr float gap_length = 5.0f;
         float current_pos = 0.0f;
         bool is_dash = true;
 
         while (current_pos < line_length) {
-          float segment_length = is_dash ? dash_length : gap_length;
+          float segment_length = is_dash ? kDashLength : kGapLength;
           float end_pos = std::min(current_pos + segment_length, line_length);
 
           if (is_dash) {
             QVector2D start_point =
                 QVector2D(s1.x(), s1.y()) + dir * current_pos;
             QVector2D end_point = QVector2D(s1.x(), s1.y()) + dir * end_pos;
-
-            glVertex2f(start_point.x() + perp.x(), start_point.y() + perp.y());
-            glVertex2f(start_point.x() - perp.x(), start_point.y() - perp.y());
-            glVertex2f(end_point.x() - perp.x(), end_point.y() - perp.y());
-            glVertex2f(end_point.x() + perp.x(), end_point.y() + perp.y());
+            addQuad(start_point, end_point, perp);
           }
 
           current_pos = end_pos;
           is_dash = !is_dash;
         }
       } else {  // Solid thick line
-        glVertex2f(s1.x() + perp.x(), s1.y() + perp.y());
-        glVertex2f(s1.x() - perp.x(), s1.y() - perp.y());
-        glVertex2f(s2.x() - perp.x(), s2.y() - perp.y());
-        glVertex2f(s2.x() + perp.x(), s2.y() + perp.y());
+        addQuad(s1.toVector2D(), s2.toVector2D(), perp);
       }
     }
   }
-  glEnd();
-
-  // Restore OpenGL state
-  glEnable(GL_DEPTH_TEST);
-  glMatrixMode(GL_PROJECTION);
-  glPopMatrix();
-  glMatrixMode(GL_MODELVIEW);
-  glPopMatrix();
+  return triangles;
 }
 
 }  // namespace s21
@@ -1,11 +1,22 @@
 #ifndef S21_GLWIDGET_H
 #define S21_GLWIDGET_H
 
+#include <QElapsedTimer>
+#include <QMatrix4x4>
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
 #include <QOpenGLWidget>
+#include <QTimer>
+#include <QVector2D>
+#include <QVector3D>
+#include <memory>
+#include <span>
 #include <vector>
 
+#include "../model/load_preview.h"
+#include "../model/mesh_bvh.h"
 #include "options.h"
 
 namespace s21 {
@@ -17,11 +28,36 @@ namespace s21 {
  * It handles the loading of vertex and index data, rendering of the model with
  * various options (projection type, colors, line styles, etc.), and provides
  * methods for manipulating the view.
+ *
+ * The model is drawn with GLSL programs and vertex arrays on OpenGL 3.3 and
+ * later, with the projection, view and model matrices passed as uniforms.
+ * On older contexts, or when S21_GL_LEGACY is set, it falls back to the
+ * fixed-function pipeline; both renderers draw the same picture.
+ *
+ * A mesh that comes with a bounding volume hierarchy is culled against the
+ * view frustum every frame, and only the edges and points of visible
+ * clusters are drawn. When simplified levels of the mesh are set, the
+ * coarsest one with enough triangles for the model's size on screen is
+ * drawn instead of the full mesh.
+ *
+ * While the model is being moved quickly, or a full frame exceeds the
+ * frame budget of the options, a proxy is drawn: the coarsest level, or
+ * a subset of the vertices if there are none. Full detail returns once the
+ * model has stopped moving for a moment.
  */
 class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
   Q_OBJECT
 
  public:
+  /**
+   * @brief A simplified version of the shown mesh, in the same coordinates.
+   */
+  struct Level {
+    std::span<const float> vertices;      // Vertex coordinates (x, y, z).
+    std::span<const unsigned int> edges;  // Unique edges as index pairs.
+    size_t triangles;                     // Number of its triangles.
+  };
+
   /**
    * @brief Constructs a GLWidget.
    * @param parent The parent widget.
@@ -34,18 +70,110 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
   ~GLWidget() override;
 
   /**
-   * @brief Sets the vertex data for the model.
-   * @param vertices A vector of floats representing the vertex coordinates (x,
-   * y, z).
+   * @brief Requests a context suitable for the core profile renderer.
+   *
+   * Must be called before the application creates any window.
+   */
+  static void setDefaultFormat();
+
+  /**
+   * @brief Shows a mesh without copying it on the CPU.
+   *
+   * The data is uploaded to the GPU and the widget keeps only a read-only
+   * view of it, so the caller must keep both arrays alive and unchanged until
+   * the next setMesh() call. Clears any provisional normalization.
+   * @param vertices Normalized vertex coordinates (x, y, z).
+   * @param edges Unique edges as index pairs, drawn as GL_LINES.
+   */
+  void setMesh(std::span<const float> vertices,
+               std::span<const unsigned int> edges = {});
+
+  /**
+   * @brief Re-uploads a changed range of the shown vertices.
+   *
+   * Used when vertex positions changed but the topology did not: only the
+   * range is written into the existing GPU buffer, nothing is reallocated.
+   * @param vertices All vertex coordinates (x, y, z); the array may have
+   * moved, but its size must be the same as in setMesh().
+   * @param first The first changed vertex.
+   * @param last The vertex after the last changed one.
+   * @return False if this is not possible; call setMesh() instead.
+   */
+  bool updateVertices(std::span<const float> vertices, size_t first,
+                      size_t last);
+
+  /**
+   * @brief Sets the clusters used for frustum culling of the shown mesh.
+   *
+   * Must be called after setMesh(), which clears them. Like the mesh, both
+   * arrays are viewed, not copied; the node bounds may change in place
+   * together with the vertices.
+   * @param nodes The hierarchy over the mesh; the edges passed to setMesh()
+   * must be grouped by its nodes.
+   * @param points Vertex indices grouped by its nodes.
+   */
+  void setClusters(std::span<const Bvh_node> nodes,
+                   std::span<const unsigned int> points);
+
+  /**
+   * @brief Sets the levels of detail of the shown mesh.
+   *
+   * Must be called after setMesh(), which clears them. The data is uploaded
+   * to the GPU and viewed, not copied, like the mesh itself.
+   * @param levels Levels from the finest to the coarsest; empty to always
+   * draw the full mesh.
+   */
+  void setLevels(std::vector<Level> levels);
+
+  /**
+   * @brief Starts an empty mesh to be filled by the append functions.
+   *
+   * Used to show a model while it is still loading. The GPU buffers are
+   * allocated at the expected size of the whole model, and each batch is
+   * written straight into them; the widget keeps no CPU copy. A buffer
+   * that turns out too small is moved to one twice as large. setMesh()
+   * ends the appending.
+   * @param size The expected size of the model, e.g. from
+   * Load_preview::estimate().
+   */
+  void startAppending(const Preview_size& size);
+
+  /**
+   * @brief Appends vertices to the end of the vertex buffer.
+   * @param vertices New vertex coordinates (x, y, z); may be freed once the
+   * call returns.
+   */
+  void appendVertexData(std::span<const float> vertices);
+
+  /**
+   * @brief Appends edges to the end of the edge buffer.
+   * @param edges New edges as index pairs into the whole vertex buffer.
+   */
+  void appendEdgeData(std::span<const unsigned int> edges);
+
+  /**
+   * @brief Sets a normalization applied at draw time, for a partially loaded
+   * model whose final bounds are not known yet.
+   *
+   * Cleared by setMesh(), which receives already normalized vertices.
+   * @param center The center of the loaded part.
+   * @param scale The divisor that fits the loaded part into the view.
+   */
+  void setProvisionalNormalization(const QVector3D& center, float scale);
+
+  /**
+   * @brief Gets the number of vertices currently held by the widget.
    */
-  void setVertexData(const std::vector<float>& vertices);
+  int vertexCount() const { return m_vertexCount / 3; }
 
   /**
-   * @brief Sets the index data for the model.
-   * @param indices A vector of unsigned integers representing the indices of
-   * the vertices that form the faces of the model.
+   * @brief Sets the model matrix applied to the vertices at draw time.
+   *
+   * Translating, rotating or scaling the model only changes this matrix, so
+   * the vertex and index buffers are not uploaded again.
+   * @param matrix The model transform.
    */
-  void setIndexData(const std::vector<unsigned int>& indices);
+  void setModelMatrix(const QMatrix4x4& matrix);
 
   /**
    * @brief Sets the projection type (orthographic or perspective).
@@ -65,6 +193,27 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
    */
   void setOptions(const Options& options);
 
+ signals:
+  /**
+   * @brief Emitted when the share of triangles outside the view changes.
+   * @param percent The culled share, 0 to 100.
+   */
+  void culledChanged(int percent);
+
+  /**
+   * @brief Emitted when a different level of detail is drawn.
+   * @param level The index of the level, or -1 for the full mesh.
+   * @param proxy Whether the model is drawn simplified because it is being
+   * moved; with no levels the proxy is a subset of the vertices.
+   */
+  void detailChanged(int level, bool proxy);
+
+  /**
+   * @brief Emitted once the context is set up and a renderer is chosen.
+   * @param name A short name of the renderer in use.
+   */
+  void rendererChanged(const QString& name);
+
  protected:
   /**
    * @brief Initializes the OpenGL context and resources.
@@ -85,26 +234,207 @@ class GLWidget : public QOpenGLWidget, protected QOpenGLFunctions {
 
  private:
   /**
-   * @brief Draws thick lines for the edges of the model.
+   * @brief Builds the shader programs and vertex arrays of the core renderer.
+   * @return True if the core renderer can be used.
+   */
+  bool initializeCore();
+
+  /**
+   * @brief Renders the model with shader programs and vertex arrays.
+   */
+  void paintCore();
+
+  /**
+   * @brief Renders the model with the fixed-function pipeline.
+   */
+  void paintLegacy();
+
+  /**
+   * @brief Gets the projection matrix for the current projection type.
+   */
+  QMatrix4x4 projectionMatrix() const;
+
+  /**
+   * @brief Gets the view matrix, which moves the camera back.
+   */
+  QMatrix4x4 viewMatrix() const;
+
+  /**
+   * @brief Gets the model matrix, including any provisional normalization.
+   */
+  QMatrix4x4 modelMatrix() const;
+
+  /**
+   * @brief Collects the edge and point ranges of the clusters in view.
+   * @param mvp The full model-view-projection matrix.
+   */
+  void cullClusters(const QMatrix4x4& mvp);
+
+  /**
+   * @brief Picks the level of detail for the model's size on screen.
+   * @param mvp The full model-view-projection matrix.
+   * @return The index of the level, or -1 for the full mesh.
+   */
+  int selectLevel(const QMatrix4x4& mvp) const;
+
+  /**
+   * @brief Releases the GPU buffers of the levels of detail.
+   */
+  void clearLevels();
+
+  /**
+   * @brief Whether this frame draws a proxy instead of the full detail.
+   */
+  bool useProxy() const;
+
+  /**
+   * @brief Uploads the subset of vertices drawn as the proxy of a mesh
+   * without levels of detail.
+   */
+  void updateProxyPoints();
+
+  /**
+   * @brief Gets the vertices drawn this frame: the mesh or the chosen level.
+   */
+  std::span<const float> shownVertices() const;
+
+  /**
+   * @brief Gets the edges drawn this frame: the mesh or the chosen level.
    */
-  void drawThickLines();
+  std::span<const unsigned int> shownEdges() const;
+
+  /**
+   * @brief Whether this frame draws only the clusters in view.
+   */
+  bool culling() const { return m_level < 0 && !m_clusters.empty(); }
+
+  /**
+   * @brief Draws the given ranges of the bound index buffer.
+   * @param mode The primitive type.
+   * @param ranges Ranges of indices.
+   */
+  void drawRanges(GLenum mode, const std::vector<std::pair<int, int>>& ranges);
+
+  /**
+   * @brief Builds thick or dashed lines for the edges of the model.
+   * @param mvp The full model-view-projection matrix.
+   * @param viewport The viewport the lines are drawn into.
+   * @return Triangles in window coordinates.
+   */
+  std::vector<QVector2D> thickLineTriangles(const QMatrix4x4& mvp,
+                                            const GLint viewport[4]) const;
+
+  /**
+   * @brief Gets the radius of circle points in model units.
+   */
+  float circleRadius() const;
+
+  /**
+   * @brief Draws filled circles around the vertices, in model coordinates,
+   * with the fixed-function pipeline.
+   */
+  void drawCircles();
+
+  /**
+   * @brief Writes a range after the used part of a GPU buffer, growing it
+   * if needed.
+   * @param buffer The buffer to write to.
+   * @param used The size of the used part in bytes.
+   * @param data The new range.
+   * @param bytes The size of the new range in bytes.
+   * @param capacity The allocated size of the buffer in bytes (updated).
+   */
+  void appendToBuffer(QOpenGLBuffer& buffer, int used, const void* data,
+                      int bytes, int& capacity);
+
+  /**
+   * @brief Replaces the contents of a buffer, reusing its storage if the
+   * size fits.
+   * @param buffer The buffer to write to.
+   * @param data The new contents.
+   * @param bytes The size of the new contents in bytes.
+   * @param capacity The allocated size of the buffer in bytes (updated).
+   */
+  void writeBuffer(QOpenGLBuffer& buffer, const void* data, int bytes,
+                   int& capacity);
 
   // Vertex Buffer Object for storing vertex data on the GPU.
   QOpenGLBuffer m_vertexBuffer;
-  // Index Buffer Object for storing index data on the GPU.
-  QOpenGLBuffer m_indexBuffer;
+  // Unique edges as GL_LINES index pairs.
+  QOpenGLBuffer m_edgeBuffer;
+  // Vertex indices grouped by cluster, drawn as GL_POINTS.
+  QOpenGLBuffer m_pointBuffer;
+
+  // Whether the core profile renderer is used.
+  bool m_core = false;
+  // Programs of the core renderer: plain model geometry, thick or dashed
+  // edges expanded by a geometry shader, and point sprites.
+  std::unique_ptr<QOpenGLShaderProgram> m_meshProgram;
+  std::unique_ptr<QOpenGLShaderProgram> m_lineProgram;
+  std::unique_ptr<QOpenGLShaderProgram> m_pointProgram;
+  // Vertex arrays of the triangles, of the edges and of the culled points.
+  QOpenGLVertexArrayObject m_meshVao;
+  QOpenGLVertexArrayObject m_edgeVao;
+  QOpenGLVertexArrayObject m_pointVao;
 
   int m_width;        // Width of the widget.
   int m_height;       // Height of the widget.
   int m_vertexCount;  // Number of vertices in the model.
-  int m_indexCount;   // Number of indices in the model.
+  int m_edgeCount = 0;  // Number of indices in the edge buffer.
+  int m_vertexCapacity = 0;  // Allocated size of the vertex buffer in bytes.
+  int m_edgeCapacity = 0;    // Allocated size of the edge buffer in bytes.
+  int m_pointCapacity = 0;   // Allocated size of the point buffer in bytes.
+
+  // Accumulated model transform, applied on the GPU.
+  QMatrix4x4 m_modelMatrix;
+
+  // Draw-time normalization of a partially loaded model.
+  bool m_provisional = false;
+  QVector3D m_provisionalCenter;
+  float m_provisionalScale = 1.0f;
 
   // Rendering options.
   Options m_options;
-  // A copy of the vertex data stored on the CPU.
-  std::vector<float> m_vertexData;
-  // A copy of the index data stored on the CPU.
-  std::vector<unsigned int> m_originalIndices;
+  // Read-only view of the vertex data shown, for CPU-side drawing.
+  std::span<const float> m_vertexData;
+  // A loading model is being appended; only the GPU holds its data.
+  bool m_appending = false;
+  // Read-only view of the unique edges as (min, max) index pairs.
+  std::span<const unsigned int> m_edges;
+  // Read-only views of the cluster hierarchy and of its grouped points.
+  std::span<const Bvh_node> m_clusters;
+  std::span<const unsigned int> m_points;
+  // (first, count) index ranges to draw this frame, set by cullClusters().
+  std::vector<std::pair<int, int>> m_edgeRanges;
+  std::vector<std::pair<int, int>> m_pointRanges;
+  // Share of triangles culled in the last frame, in percent.
+  int m_culledPercent = 0;
+
+  // GPU copy of a level of detail.
+  struct LevelBuffers {
+    Level data;
+    QOpenGLBuffer vertexBuffer{QOpenGLBuffer::VertexBuffer};
+    QOpenGLBuffer edgeBuffer{QOpenGLBuffer::IndexBuffer};
+    std::unique_ptr<QOpenGLVertexArrayObject> vao;
+  };
+  std::vector<LevelBuffers> m_levels;
+  // Level drawn in the current frame, or -1 for the full mesh.
+  int m_level = -1;
+
+  // Adaptive quality: while the model is being moved quickly, or a full
+  // frame takes longer than Options::frameBudget, a proxy is drawn.
+  QElapsedTimer m_sinceMove;  // Time since the model matrix last changed.
+  QTimer m_idleTimer;         // Ends the manipulation once input stops.
+  bool m_moving = false;      // The model matrix changed recently.
+  bool m_rapid = false;       // The last two changes came in quick succession.
+  double m_fullFrameTime = 0;  // Duration of the last full frame, in ms.
+  bool m_proxy = false;        // The current frame draws the proxy.
+  // Every n-th vertex, drawn as GL_POINTS when there are no levels.
+  QOpenGLBuffer m_proxyBuffer;
+  QOpenGLVertexArrayObject m_proxyVao;
+  int m_proxyCount = 0;
+  int m_proxyCapacity = 0;
+  bool m_proxyDirty = true;
 };
 
 }  // namespace s21
@@ -5,6 +5,7 @@
 
 #include <QApplication>
 
+#include "glwidget.h"
 #include "mainwindow.h"
 
 /**
@@ -14,8 +15,11 @@
  * @return The exit code of the application.
  */
 int main(int argc, char* argv[]) {
+  s21::GLWidget::setDefaultFormat();
   QApplication app(argc, argv);
   s21::MainWindow w;
   w.show();
+  // An optional argument names the model to open; "-" reads standard input
+  if (argc > 1) w.openFile(QString::fromLocal8Bit(argv[1]));
   return app.exec();
 }
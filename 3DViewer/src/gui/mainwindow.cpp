@@ -14,15 +14,42 @@
 #include <QLabel>
 #include <QLineEdit>
 #include <QMessageBox>
+#include <QProgressBar>
 #include <QPushButton>
+#include <QShortcut>
+#include <QStandardPaths>
 #include <QTimer>
 #include <QVBoxLayout>
 #include <fstream>
+#include <thread>
 
 #include "glwidget.h"
 
 namespace s21 {
 
+// Vertex, Triangle and Edge already have the layout of the GPU buffers
+static_assert(sizeof(Vertex) == 3 * sizeof(float));
+static_assert(sizeof(Triangle) == 3 * sizeof(unsigned int));
+static_assert(sizeof(Edge) == 2 * sizeof(unsigned int));
+
+// Views vertices as the flat (x, y, z) float array uploaded to the GPU
+std::span<const float> asFloats(std::span<const Vertex> vertices) {
+  return {reinterpret_cast<const float*>(vertices.data()),
+          vertices.size() * 3};
+}
+
+// Views edges as the flat GL_LINES index array uploaded to the GPU
+std::span<const unsigned int> asIndices(std::span<const Edge> edges) {
+  return {reinterpret_cast<const unsigned int*>(edges.data()),
+          edges.size() * 2};
+}
+
+// Views vertex numbers as the flat GL_POINTS index array uploaded to the GPU
+std::span<const unsigned int> asIndices(std::span<const int> points) {
+  return {reinterpret_cast<const unsigned int*>(points.data()),
+          points.size()};
+}
+
 // Helper function to populate a color combo box with standard colors
 void populateColorComboBox(QComboBox* comboBox) {
   comboBox->addItem("Black", QColor(Qt::black));
@@ -43,6 +70,18 @@ void populateColorComboBox(QComboBox* comboBox) {
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
   setupUi();
 
+  // Parsed models are cached as .s21mesh files in the user cache directory;
+  // the least recently used ones are dropped beyond kCacheLimit bytes
+  constexpr uint64_t kCacheLimit = uint64_t(2) << 30;
+  QString cacheDir =
+      QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+  if (!cacheDir.isEmpty()) {
+    controller.executeCommand(std::make_unique<CacheCommand>(
+        true, QDir(cacheDir).filePath("meshes").toStdString(), kCacheLimit));
+  }
+  controller.executeCommand(
+      std::make_unique<ThreadsCommand>(std::thread::hardware_concurrency()));
+
   Options options;
   std::ifstream settings_file("settings.conf");
   if (settings_file.is_open()) {
@@ -62,6 +101,13 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
       {m_translateLeftButton, {-1, 0, 0}},
       {m_translateRightButton, {1, 0, 0}},
   };
+  // Holding a step button repeats it; the repeats are merged into one command
+  for (const auto& [button, axis] : rotateButtons_)
+    button->setAutoRepeat(true);
+  for (const auto& [button, direction] : translateButtons_)
+    button->setAutoRepeat(true);
+  m_scaleUpButton->setAutoRepeat(true);
+  m_scaleDownButton->setAutoRepeat(true);
 
   // Initialize UI with loaded options
   m_projectionTypeComboBox->setCurrentIndex(
@@ -70,6 +116,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
   m_edgeThicknessEdit->setText(QString::number(options.lineThickness));
   m_vertexMethodComboBox->setCurrentIndex(static_cast<int>(options.pointType));
   m_vertexSizeEdit->setText(QString::number(options.pointSize));
+  m_frameBudgetEdit->setText(QString::number(options.frameBudget));
 
   // Set initial colors
   m_edgeColorComboBox->setCurrentIndex(
@@ -95,6 +142,7 @@ MainWindow::~MainWindow() {
   currentOptions.pointType =
       static_cast<PointType>(m_vertexMethodComboBox->currentIndex());
   currentOptions.pointSize = m_vertexSizeEdit->text().toInt();
+  currentOptions.frameBudget = m_frameBudgetEdit->text().toInt();
   currentOptions.color = m_edgeColorComboBox->currentData().value<QColor>();
   currentOptions.pointColor =
       m_vertexColorComboBox->currentData().value<QColor>();
@@ -139,12 +187,22 @@ void MainWindow::setupUi() {
   column1Layout->addWidget(new QLabel("<h3>File & Model Info</h3>", this));
   m_loadButton = new QPushButton("Select .obj File", this);
   m_fileNameLabel = new QLabel("No file selected.", this);
+  m_loadProgress = new QProgressBar(this);
+  m_loadProgress->setRange(0, 100);
+  m_loadProgress->hide();
   m_verticesLabel = new QLabel("<b>Vertices:</b> 0", this);
   m_edgesLabel = new QLabel("<b>Edges:</b> 0", this);
+  m_culledLabel = new QLabel("<b>Culled:</b> 0%", this);
+  m_lodLabel = new QLabel("<b>Detail:</b> full", this);
+  m_rendererLabel = new QLabel("<b>Renderer:</b> -", this);
   column1Layout->addWidget(m_loadButton);
   column1Layout->addWidget(m_fileNameLabel);
+  column1Layout->addWidget(m_loadProgress);
   column1Layout->addWidget(m_verticesLabel);
   column1Layout->addWidget(m_edgesLabel);
+  column1Layout->addWidget(m_culledLabel);
+  column1Layout->addWidget(m_lodLabel);
+  column1Layout->addWidget(m_rendererLabel);
   column1Layout->addStretch();
 
   // --- Display Settings ---
@@ -196,6 +254,16 @@ void MainWindow::setupUi() {
   vertexSettingsLayout->addWidget(m_vertexColorComboBox, 2, 1);
   column1Layout->addLayout(vertexSettingsLayout);
 
+  // Frame budget while the model is being moved
+  QHBoxLayout* frameBudgetLayout = new QHBoxLayout();
+  frameBudgetLayout->addWidget(new QLabel("Frame Budget (ms):", this));
+  m_frameBudgetEdit = new QLineEdit("50", this);
+  m_frameBudgetEdit->setToolTip(
+      "A simplified model is drawn while moving if a frame takes longer; "
+      "0 always draws the full model");
+  frameBudgetLayout->addWidget(m_frameBudgetEdit);
+  column1Layout->addLayout(frameBudgetLayout);
+
   // Background Color
   QHBoxLayout* backgroundColorLayout = new QHBoxLayout();
   backgroundColorLayout->addWidget(new QLabel("Background Color:", this));
@@ -306,8 +374,31 @@ void MainWindow::setupUi() {
   // --- Connect Signals to Slots ---
   connect(m_loadButton, &QPushButton::clicked, this,
           &MainWindow::onLoadFileClicked);
+  load_timer_ = new QTimer(this);
+  connect(load_timer_, &QTimer::timeout, this, &MainWindow::onLoadProgress);
+  refresh_timer_ = new QTimer(this);
+  refresh_timer_->setSingleShot(true);
+  refresh_timer_->setInterval(16);  // about one display frame
+  connect(refresh_timer_, &QTimer::timeout, this, &MainWindow::onRefresh);
+  lod_timer_ = new QTimer(this);
+  connect(lod_timer_, &QTimer::timeout, this, &MainWindow::onLodProgress);
   connect(m_screenshotButton, &QPushButton::clicked, this,
           &MainWindow::onScreenshotButtonClicked);
+  connect(m_glWidget, &GLWidget::culledChanged, this, [this](int percent) {
+    m_culledLabel->setText(QString("<b>Culled:</b> %1%").arg(percent));
+  });
+  connect(m_glWidget, &GLWidget::rendererChanged, this,
+          [this](const QString& name) {
+            m_rendererLabel->setText("<b>Renderer:</b> " + name);
+          });
+  connect(m_glWidget, &GLWidget::detailChanged, this,
+          [this](int level, bool proxy) {
+            QString detail = level < 0 ? QString("full")
+                                       : QString("level %1").arg(level + 1);
+            if (proxy && level < 0) detail = "points";
+            if (proxy) detail = "proxy, " + detail;
+            m_lodLabel->setText("<b>Detail:</b> " + detail);
+          });
   connect(m_recordButton, &QPushButton::clicked, this,
           &MainWindow::onRecordButtonClicked);
 
@@ -328,6 +419,8 @@ void MainWindow::setupUi() {
           &MainWindow::onSettingsChanged);
   connect(m_backgroundColorComboBox, &QComboBox::currentIndexChanged, this,
           &MainWindow::onSettingsChanged);
+  connect(m_frameBudgetEdit, &QLineEdit::textChanged, this,
+          &MainWindow::onSettingsChanged);
 
   // Connect all transform buttons to the single slot
   connect(m_translateUpButton, &QPushButton::clicked, this,
@@ -367,13 +460,11 @@ void MainWindow::setupUi() {
   connect(m_normalizeButton, &QPushButton::clicked, this,
           &MainWindow::onResetButtonClicked);
 
-  // Rotation fields edit
-  connect(m_rotateXEdit, &QLineEdit::textEdited, this,
-          &MainWindow::onRotationInputEdited);
-  connect(m_rotateYEdit, &QLineEdit::textEdited, this,
-          &MainWindow::onRotationInputEdited);
-  connect(m_rotateZEdit, &QLineEdit::textEdited, this,
-          &MainWindow::onRotationInputEdited);
+  // Undo and redo of transformations
+  connect(new QShortcut(QKeySequence::Undo, this), &QShortcut::activated, this,
+          &MainWindow::onUndo);
+  connect(new QShortcut(QKeySequence::Redo, this), &QShortcut::activated, this,
+          &MainWindow::onRedo);
 }
 
 /**
@@ -381,14 +472,98 @@ void MainWindow::setupUi() {
  */
 void MainWindow::onLoadFileClicked() {
   QString filePath = QFileDialog::getOpenFileName(
-      this, "Open .obj File", QDir::homePath(), "OBJ Files (*.obj)");
-  if (!filePath.isEmpty()) {
-    m_fileNameLabel->setText("<b>File:</b> " + QFileInfo(filePath).fileName());
-    file_path_string = filePath.toStdString();
-    controller.executeCommand(
-        std::make_unique<s21::OpenFileCommand>(file_path_string));
-    updateUiFromModel();
+      this, "Open .obj File", QDir::homePath(),
+      "OBJ Files (*.obj *.obj.gz *.obj.zst)");
+  if (!filePath.isEmpty()) openFile(filePath);
+}
+
+/**
+ * @brief Loads a model given by path, e.g. from the command line.
+ * @param filePath The path to an .obj file, possibly gzip or zstd
+ * compressed; "-" reads standard input.
+ */
+void MainWindow::openFile(const QString& filePath) {
+  m_fileNameLabel->setText("<b>Loading:</b> " +
+                           (filePath == "-" ? QString("stdin")
+                                            : QFileInfo(filePath).fileName()));
+  startLoading(filePath.toStdString());
+}
+
+/**
+ * @brief Starts loading a file in the background.
+ *
+ * The current model stays on screen and responds to transformations until the
+ * new one is ready. Large files are instead shown progressively as they are
+ * parsed. Starting another load cancels the previous one.
+ * @param path The path to the .obj file.
+ */
+void MainWindow::startLoading(const std::string& path) {
+  // Files this large take seconds to parse, so they are shown while loading
+  constexpr qint64 kProgressiveSize = 32 << 20;
+  pending_path_ = path;
+  previewing_ = false;
+  controller.loadModelAsync(
+      path, std::thread::hardware_concurrency(),
+      QFileInfo(QString::fromStdString(path)).size() >= kProgressiveSize);
+  m_loadProgress->setValue(0);
+  m_loadProgress->setFormat("%p%");
+  m_loadProgress->show();
+  load_timer_->start(50);
+}
+
+/**
+ * @brief Polls the background load, updates the progress bar and swaps in the
+ * new model once it is ready.
+ */
+void MainWindow::onLoadProgress() {
+  if (const Load_progress* progress = controller.loadProgress()) {
+    size_t total = progress->bytes_total;
+    if (total > 0) {
+      m_loadProgress->setValue(
+          static_cast<int>(100.0 * progress->bytes_read / total));
+    }
+    m_loadProgress->setFormat(
+        QString("%p% (%1 faces)").arg(progress->faces_parsed.load()));
+  }
+  if (controller.isLoading() && !controller.finishLoad()) {
+    showPreview();
+    return;
   }
+
+  load_timer_->stop();
+  m_loadProgress->hide();
+  previewing_ = false;
+  file_path_string = pending_path_;
+  m_fileNameLabel->setText(
+      "<b>File:</b> " +
+      QFileInfo(QString::fromStdString(file_path_string)).fileName());
+  updateUiFromModel();
+}
+
+/**
+ * @brief Appends the newly parsed part of a progressively loaded model to the
+ * view and refits it to the bounds loaded so far.
+ *
+ * The final model replaces the preview and its normalization once loading
+ * completes.
+ */
+void MainWindow::showPreview() {
+  Load_preview* preview = controller.loadPreview();
+  if (!preview || !preview->take(preview_batch_)) return;
+  const Preview_batch& batch = preview_batch_;
+
+  if (!previewing_) {
+    previewing_ = true;
+    m_glWidget->startAppending(
+        Load_preview::estimate(controller.loadProgress()->bytes_total));
+  }
+  // The batch goes straight to the GPU; its arrays return to the parser
+  m_glWidget->appendVertexData(asFloats(batch.vertices));
+  m_glWidget->appendEdgeData(batch.edges);
+  m_glWidget->setProvisionalNormalization(
+      QVector3D(batch.center.x, batch.center.y, batch.center.z), batch.scale);
+  m_verticesLabel->setText(
+      QString("<b>Vertices:</b> %1").arg(m_glWidget->vertexCount()));
 }
 
 /**
@@ -396,40 +571,42 @@ void MainWindow::onLoadFileClicked() {
  */
 void MainWindow::onTransformButtonClicked() {
   QPushButton* button = dynamic_cast<QPushButton*>(sender());
-  if (!button) return;
+  if (!button || previewing_) return;
 
   if (translateButtons_.count(button)) {
-    controller.executeCommand(
+    controller.enqueueCommand(
         std::make_unique<TranslateCommand>(translateButtons_.at(button), true));
   } else if (rotateButtons_.count(button)) {
-    controller.executeCommand(
+    controller.enqueueCommand(
         std::make_unique<RotateCommand>(rotateButtons_.at(button), true));
   } else if (button == m_applyTranslateButton) {
     float x = m_translateXEdit->text().toFloat();
     float y = m_translateYEdit->text().toFloat();
     float z = m_translateZEdit->text().toFloat();
-    controller.executeCommand(
+    controller.enqueueCommand(
         std::make_unique<TranslateCommand>(Vertex{x, y, z}, false));
   } else if (button == m_applyRotateButton) {
     float x = m_rotateXEdit->text().toFloat();
     float y = m_rotateYEdit->text().toFloat();
     float z = m_rotateZEdit->text().toFloat();
-    controller.executeCommand(
+    // All three angles are applied at once, as one rotation matrix
+    controller.enqueueCommand(
         std::make_unique<RotateCommand>(Vertex{x, y, z}, false));
   } else if (button == m_scaleUpButton) {
-    controller.executeCommand(std::make_unique<ScaleCommand>(1.1f, false));
+    controller.enqueueCommand(std::make_unique<ScaleCommand>(1.1f, false));
   } else if (button == m_scaleDownButton) {
-    controller.executeCommand(std::make_unique<ScaleCommand>(0.9f, false));
+    controller.enqueueCommand(std::make_unique<ScaleCommand>(0.9f, false));
   } else if (button == m_applyScaleButton) {
     float scale = m_scaleEdit->text().toFloat();
     if (scale > 0) {
-      controller.executeCommand(std::make_unique<ScaleCommand>(scale, false));
+      controller.enqueueCommand(std::make_unique<ScaleCommand>(scale, false));
     } else {
       QMessageBox::warning(this, "Invalid Scale",
                            "Scale value must be greater than 0.");
     }
   }
-  updateUiFromModel();
+  // Bursts of clicks (or auto-repeat) are merged and shown once per frame
+  if (!refresh_timer_->isActive()) refresh_timer_->start();
 }
 
 /**
@@ -437,68 +614,123 @@ void MainWindow::onTransformButtonClicked() {
  */
 void MainWindow::onResetButtonClicked() {
   QPushButton* button = dynamic_cast<QPushButton*>(sender());
-  if (!button) return;
+  if (!button || previewing_) return;
 
   if (button == m_normalizeButton) {
     controller.executeCommand(std::make_unique<NormalizeCommand>());
   } else if (button == m_resetButton) {
-    controller.executeCommand(
-        std::make_unique<s21::OpenFileCommand>(file_path_string));
+    // The model restores its loaded geometry itself, without reading the file
+    bool baked = controller.getModel().isBaked();
+    controller.executeCommand(std::make_unique<ResetCommand>());
+    if (baked) {
+      updateUiFromModel();
+      return;
+    }
   }
-  updateUiFromModel();
+  updateTransform();
 }
 
 /**
- * @brief Handles the text edited events of the rotation input fields.
+ * @brief Undoes the last transformation (Ctrl+Z).
  */
-void MainWindow::onRotationInputEdited() {
-  QLineEdit* active_field = dynamic_cast<QLineEdit*>(sender());
-  if (!active_field) return;
+void MainWindow::onUndo() { stepHistory(false); }
 
-  bool is_active =
-      !active_field->text().isEmpty() && active_field->text().toFloat() != 0.0f;
+/**
+ * @brief Redoes the last undone transformation (Ctrl+Shift+Z).
+ */
+void MainWindow::onRedo() { stepHistory(true); }
+
+/**
+ * @brief Moves through the transformation history.
+ *
+ * Most steps only restore the model matrix; the vertex buffer is re-uploaded
+ * only when the step had to rebuild the geometry.
+ * @param redo Whether to redo instead of undo.
+ */
+void MainWindow::stepHistory(bool redo) {
+  if (previewing_) return;
+  uint64_t geometry = controller.getModel().geometryVersion();
+  if (redo ? controller.redo() : controller.undo()) showChanges(geometry);
+}
 
-  m_rotateXEdit->setEnabled(!is_active || active_field == m_rotateXEdit);
-  m_rotateYEdit->setEnabled(!is_active || active_field == m_rotateYEdit);
-  m_rotateZEdit->setEnabled(!is_active || active_field == m_rotateZEdit);
+/**
+ * @brief Applies the queued transformations and refreshes the view once.
+ */
+void MainWindow::onRefresh() {
+  uint64_t geometry = controller.getModel().geometryVersion();
+  if (controller.flushCommands()) showChanges(geometry);
+}
 
-  if (is_active) {
-    if (active_field != m_rotateXEdit) m_rotateXEdit->clear();
-    if (active_field != m_rotateYEdit) m_rotateYEdit->clear();
-    if (active_field != m_rotateZEdit) m_rotateZEdit->clear();
-  }
+/**
+ * @brief Shows the model after commands were applied.
+ * @param geometry The model's geometry version before the commands; the
+ * vertex buffer is re-uploaded only if it changed.
+ */
+void MainWindow::showChanges(uint64_t geometry) {
+  if (controller.getModel().geometryVersion() != geometry)
+    updateUiFromModel();
+  else
+    updateTransform();
+}
+
+/**
+ * @brief Passes the model's accumulated transform to the renderer.
+ *
+ * Transformations only change this matrix, so they need no buffer upload.
+ */
+void MainWindow::updateTransform() {
+  // QMatrix4x4 takes row-major values, the model stores columns
+  QMatrix4x4 matrix(controller.getTransform().m.data());
+  m_glWidget->setModelMatrix(matrix.transposed());
 }
 
 /**
  * @brief Updates the UI with the current model data.
  */
 void MainWindow::updateUiFromModel() {
-  // Convert model data for OpenGL
+  // The widget views the controller's arrays directly; they stay valid until
+  // the geometry changes, which is always followed by another call here
   const auto& vertices = controller.getVertices();
-  std::vector<float> floated_vertex;
-  floated_vertex.reserve(vertices.size() * 3);
-  for (const auto& v : vertices) {
-    floated_vertex.push_back(v.x);
-    floated_vertex.push_back(v.y);
-    floated_vertex.push_back(v.z);
-  }
-
-  const auto& polygons = controller.getPolygons();
-  std::vector<unsigned int> indices;
-  indices.reserve(polygons.size() * 3);
-  for (const auto& tri : polygons) {
-    indices.push_back(tri.v1);
-    indices.push_back(tri.v2);
-    indices.push_back(tri.v3);
+  const auto& edges = controller.getEdges();
+  // Without a topology change only the changed vertices are re-uploaded
+  Mesh_changes changes = controller.takeChanges();
+  if (changes.topology ||
+      !m_glWidget->updateVertices(asFloats(vertices), changes.vertices_from,
+                                  changes.vertices_to)) {
+    m_glWidget->setMesh(asFloats(vertices), asIndices(edges));
+    // Edges and points are grouped by the clusters of the hierarchy
+    const Mesh_bvh& bvh = controller.getBvh();
+    if (!bvh.empty())
+      m_glWidget->setClusters(bvh.nodes(), asIndices(bvh.points()));
   }
-
-  // Update OpenGL widget
-  m_glWidget->setVertexData(floated_vertex);
-  m_glWidget->setIndexData(indices);
+  // Any geometry change restarts the build of the levels of detail
+  showLevels();
+  if (controller.isBuildingLod()) lod_timer_->start(200);
+  updateTransform();
 
   // Update info labels
   m_verticesLabel->setText(QString("<b>Vertices:</b> %1").arg(vertices.size()));
-  m_edgesLabel->setText(QString("<b>Edges:</b> %1").arg(indices.size() / 2));
+  m_edgesLabel->setText(QString("<b>Edges:</b> %1").arg(edges.size()));
+}
+
+/**
+ * @brief Polls the background build of the levels of detail and passes them
+ * to the renderer once they are ready.
+ */
+void MainWindow::onLodProgress() {
+  if (controller.finishLod()) showLevels();
+  if (!controller.isBuildingLod()) lod_timer_->stop();
+}
+
+/**
+ * @brief Passes the controller's current levels of detail to the renderer.
+ */
+void MainWindow::showLevels() {
+  std::vector<GLWidget::Level> levels;
+  for (const Lod_level& lod : controller.getLods())
+    levels.push_back({asFloats(lod.vertices), asIndices(lod.edges),
+                      lod.polygons.size()});
+  m_glWidget->setLevels(std::move(levels));
 }
 
 /**
@@ -514,6 +746,7 @@ void MainWindow::onSettingsChanged() {
   currentOptions.pointType =
       static_cast<PointType>(m_vertexMethodComboBox->currentIndex());
   currentOptions.pointSize = m_vertexSizeEdit->text().toFloat();
+  currentOptions.frameBudget = m_frameBudgetEdit->text().toInt();
 
   // For colors, get the selected color from the combo box
   currentOptions.color = m_edgeColorComboBox->currentData().value<QColor>();
@@ -13,6 +13,7 @@
 
 class QPushButton;
 class QLabel;
+class QProgressBar;
 class QGridLayout;
 class QLineEdit;
 class QComboBox;
@@ -42,16 +43,27 @@ class MainWindow : public QMainWindow {
    */
   ~MainWindow() override;
 
+  /**
+   * @brief Loads a model in the background.
+   * @param filePath The path to an .obj file, possibly gzip or zstd
+   * compressed; "-" reads standard input.
+   */
+  void openFile(const QString& filePath);
+
  private slots:
   // Slots for handling button clicks
   void onLoadFileClicked();
   void onTransformButtonClicked();
   void onResetButtonClicked();
-  void onRotationInputEdited();
+  void onUndo();
+  void onRedo();
+  void onRefresh();
   void onSettingsChanged();
   void onScreenshotButtonClicked();
   void onRecordButtonClicked();
   void recordFrame();
+  void onLoadProgress();
+  void onLodProgress();
 
  private:
   // --- UI Setup Method ---
@@ -59,10 +71,25 @@ class MainWindow : public QMainWindow {
 
   // --- UI Update Method ---
   void updateUiFromModel();
+  void updateTransform();
+  void showLevels();
+  void stepHistory(bool redo);
+  void showChanges(uint64_t geometry);
+
+  // --- Background Loading ---
+  void startLoading(const std::string& path);
+  void showPreview();
 
   // --- Member Variables ---
   Controller controller;         // The controller for managing the 3D model
   std::string file_path_string;  // The path to the currently loaded .obj file
+  std::string pending_path_;     // The path of the file being loaded
+  QTimer* load_timer_ = nullptr;  // Polls the background load
+  QTimer* refresh_timer_ = nullptr;  // Applies queued commands once a frame
+  QTimer* lod_timer_ = nullptr;  // Polls the build of the levels of detail
+  bool previewing_ = false;  // The view shows a partially loaded model
+  // Arrays taken from the preview; swapped back to the parser on each take
+  Preview_batch preview_batch_;
 
   // Maps for transform buttons
   std::unordered_map<QPushButton*, s21::Vertex> rotateButtons_;
@@ -83,10 +110,14 @@ class MainWindow : public QMainWindow {
   // File loading
   QPushButton* m_loadButton;
   QLabel* m_fileNameLabel;
+  QProgressBar* m_loadProgress;
 
   // Info display
   QLabel* m_verticesLabel;
   QLabel* m_edgesLabel;
+  QLabel* m_culledLabel;
+  QLabel* m_lodLabel;
+  QLabel* m_rendererLabel;
 
   // Transformation Control Buttons
   QPushButton* m_translateUpButton;
@@ -130,6 +161,7 @@ class MainWindow : public QMainWindow {
   QLineEdit* m_vertexSizeEdit;
   QComboBox* m_vertexColorComboBox;
   QComboBox* m_backgroundColorComboBox;
+  QLineEdit* m_frameBudgetEdit;
 
   // Screenshot and GIF record Buttons
   QPushButton* m_screenshotButton;
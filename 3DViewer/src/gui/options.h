@@ -43,6 +43,9 @@ struct Options {
   QColor pointColor = Qt::white;
   int pointSize = 1;
   QColor backgroundColor = Qt::black;
+  // Milliseconds a frame may take while the model is being moved before a
+  // simplified proxy is drawn instead; 0 always draws the full mesh.
+  int frameBudget = 50;
 
   /**
    * @brief Saves the options to a stream.
@@ -52,7 +55,8 @@ struct Options {
     out << static_cast<int>(projectionType) << " " << static_cast<int>(lineType)
         << " " << color.rgb() << " " << lineThickness << " "
         << static_cast<int>(pointType) << " " << pointColor.rgb() << " "
-        << pointSize << " " << backgroundColor.rgb() << "\n";
+        << pointSize << " " << backgroundColor.rgb() << " " << frameBudget
+        << "\n";
   }
 
   /**
@@ -74,6 +78,9 @@ struct Options {
     pointColor = QColor(pntC);
     pointSize = pntS;
     backgroundColor = QColor(bgC);
+    // Settings saved before the frame budget existed end here
+    int budget;
+    if (in >> budget) frameBudget = budget;
     return true;
   }
 };
@@ -0,0 +1,115 @@
+#ifndef S21_SHADERS_H
+#define S21_SHADERS_H
+
+/**
+ * @file shaders.h
+ * @brief GLSL sources of the core profile renderer.
+ *
+ * Kept apart from GLWidget so that `make shader_check` can compile them
+ * without Qt on a headless context.
+ */
+
+namespace s21::shaders {
+
+// Transforms model vertices; shared by edges and both kinds of points.
+inline constexpr char kMeshVertexShader[] = R"(#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+void main() {
+  gl_Position = projection * view * model * vec4(position, 1.0);
+}
+)";
+
+// Draws each vertex once as a point sprite. Square points keep a fixed
+// size in pixels; circles have a radius in model units, so they follow zoom
+// and perspective like the model does.
+inline constexpr char kPointVertexShader[] = R"(#version 330 core
+layout(location = 0) in vec3 position;
+uniform mat4 projection;
+uniform mat4 view;
+uniform mat4 model;
+uniform float size;
+uniform float radius;
+uniform float viewportHeight;
+void main() {
+  gl_Position = projection * view * model * vec4(position, 1.0);
+  if (radius > 0.0) {
+    float scale = length(model[0].xyz);
+    gl_PointSize = radius * scale * projection[1][1] / gl_Position.w *
+                   viewportHeight;
+  } else {
+    gl_PointSize = size;
+  }
+}
+)";
+
+// Cuts a circle out of the square sprite.
+inline constexpr char kPointFragmentShader[] = R"(#version 330 core
+uniform vec4 color;
+uniform bool round;
+out vec4 fragColor;
+void main() {
+  if (round && length(gl_PointCoord - 0.5) > 0.5) discard;
+  fragColor = color;
+}
+)";
+
+// Expands each edge into a quad of the given width in pixels. The edge is
+// clipped to the near plane first; the other planes clip the quad itself.
+inline constexpr char kLineGeometryShader[] = R"(#version 330 core
+layout(lines) in;
+layout(triangle_strip, max_vertices = 4) out;
+uniform vec2 viewport;
+uniform float thickness;
+noperspective out float distance;
+void emit(vec2 p, float z, float d) {
+  gl_Position = vec4(p / viewport * 2.0 - 1.0, z, 1.0);
+  distance = d;
+  EmitVertex();
+}
+void main() {
+  vec4 p1 = gl_in[0].gl_Position;
+  vec4 p2 = gl_in[1].gl_Position;
+  float d1 = p1.z + p1.w;
+  float d2 = p2.z + p2.w;
+  if (d1 < 0.0 && d2 < 0.0) return;
+  if (d1 < 0.0) p1 = mix(p1, p2, d1 / (d1 - d2));
+  if (d2 < 0.0) p2 = mix(p2, p1, d2 / (d2 - d1));
+  vec2 s1 = (p1.xy / p1.w * 0.5 + 0.5) * viewport;
+  vec2 s2 = (p2.xy / p2.w * 0.5 + 0.5) * viewport;
+  float len = length(s2 - s1);
+  if (len < 1e-6) return;
+  vec2 perp = vec2(s1.y - s2.y, s2.x - s1.x) / len * thickness * 0.5;
+  emit(s1 + perp, p1.z / p1.w, 0.0);
+  emit(s1 - perp, p1.z / p1.w, 0.0);
+  emit(s2 + perp, p2.z / p2.w, len);
+  emit(s2 - perp, p2.z / p2.w, len);
+  EndPrimitive();
+}
+)";
+
+// Cuts dashes by the distance from the start of the edge.
+inline constexpr char kLineFragmentShader[] = R"(#version 330 core
+uniform vec4 color;
+uniform bool dashed;
+uniform float dash;
+uniform float gap;
+noperspective in float distance;
+out vec4 fragColor;
+void main() {
+  if (dashed && mod(distance, dash + gap) >= dash) discard;
+  fragColor = color;
+}
+)";
+
+inline constexpr char kColorFragmentShader[] = R"(#version 330 core
+uniform vec4 color;
+out vec4 fragColor;
+void main() { fragColor = color; }
+)";
+
+}  // namespace s21::shaders
+
+#endif  // S21_SHADERS_H
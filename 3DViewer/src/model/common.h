@@ -8,16 +8,19 @@
 
 #pragma once
 
+#include <algorithm>  // std::min, std::max
+#include <array>      // std::array
+#include <atomic>     // std::atomic
 #include <cmath>      // std::abs
+#include <cstdint>    // uint64_t
+#include <cstddef>    // size_t
 #include <iostream>   // std::ostream
+#include <span>       // std::span
 #include <stdexcept>  // std::runtime_error
 #include <vector>     // std::vector
 
 namespace s21 {
 
-// обозначение осей
-typedef enum { uninitalized, X, Y, Z } Axis;
-
 /**
  * @struct Vertex
  * @brief Представляет 3D-вершину модели.
@@ -84,6 +87,147 @@ using Vertices = std::vector<Vertex>;
  */
 using Polygons = std::vector<Triangle>;
 
+/**
+ * @struct Edge
+ * @brief Ребро по индексам двух вершин, v1 < v2.
+ */
+struct Edge {
+  int v1, v2;
+
+  bool operator==(const Edge &other) const = default;
+};
+
+/**
+ * @brief Удобный псевдоним для списка рёбер.
+ */
+using Edges = std::vector<Edge>;
+
+/**
+ * @struct Faces
+ * @brief Полигоны произвольной длины в плоском (CSR) представлении.
+ *
+ * Индексы всех полигонов лежат подряд в `indices`, полигон `i` занимает
+ * диапазон `[offsets[i], offsets[i + 1])`. В отличие от вектора векторов,
+ * отдельный полигон не требует собственного выделения памяти.
+ *
+ * Новый полигон набирается добавлением индексов в конец `indices` и
+ * фиксируется close_face() либо отбрасывается discard_face().
+ */
+struct Faces {
+  /**
+   * @brief Индексы вершин всех полигонов подряд.
+   */
+  std::vector<int> indices;
+
+  /**
+   * @brief Начало каждого полигона в `indices` и общий конец.
+   */
+  std::vector<size_t> offsets{0};
+
+  /**
+   * @brief Количество полигонов.
+   */
+  size_t size() const { return offsets.size() - 1; }
+  bool empty() const { return size() == 0; }
+
+  std::span<const int> operator[](size_t i) const {
+    return {indices.data() + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+  std::span<int> operator[](size_t i) {
+    return {indices.data() + offsets[i], offsets[i + 1] - offsets[i]};
+  }
+
+  void clear() {
+    indices.clear();
+    offsets.assign(1, 0);
+  }
+
+  /**
+   * @brief Резервирует место под полигоны.
+   * @param faces Количество полигонов.
+   * @param total Суммарное количество индексов.
+   */
+  void reserve(size_t faces, size_t total) {
+    offsets.reserve(faces + 1);
+    indices.reserve(total);
+  }
+
+  /**
+   * @brief Количество индексов незафиксированного полигона.
+   */
+  size_t open_size() const { return indices.size() - offsets.back(); }
+
+  /**
+   * @brief Фиксирует набранный полигон.
+   */
+  void close_face() { offsets.push_back(indices.size()); }
+
+  /**
+   * @brief Отбрасывает набранный полигон.
+   */
+  void discard_face() { indices.resize(offsets.back()); }
+
+  bool operator==(const Faces &other) const = default;
+};
+
+/**
+ * @struct Matrix4
+ * @brief Аффинное преобразование 4×4, хранится по столбцам (как в OpenGL).
+ *
+ * Методы translate() и scale() дописывают преобразование *после* уже
+ * накопленного (`M = T · M`), то есть действуют так же, как те же операции
+ * над вершинами, применённые по очереди. Поворот дописывается через
+ * столбцы, см. column().
+ */
+struct Matrix4 {
+  /**
+   * @brief Элементы по столбцам: `m[column * 4 + row]`.
+   */
+  std::array<float, 16> m = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+
+  /**
+   * @brief Применяет преобразование к точке.
+   */
+  Vertex apply(Vertex v) const {
+    return {m[0] * v.x + m[4] * v.y + m[8] * v.z + m[12],
+            m[1] * v.x + m[5] * v.y + m[9] * v.z + m[13],
+            m[2] * v.x + m[6] * v.y + m[10] * v.z + m[14]};
+  }
+
+  /**
+   * @brief Добавляет сдвиг на вектор.
+   */
+  void translate(Vertex d) {
+    m[12] += d.x;
+    m[13] += d.y;
+    m[14] += d.z;
+  }
+
+  /**
+   * @brief Добавляет масштабирование относительно начала координат.
+   */
+  void scale(float f) {
+    for (int column = 0; column < 4; column++)
+      for (int row = 0; row < 3; row++) m[column * 4 + row] *= f;
+  }
+
+  /**
+   * @brief Первые три строки столбца как вектор.
+   *
+   * Поворот `R · M` — это поворот каждого столбца, поэтому столбцы можно
+   * передать той же стратегии поворота, что и вершины.
+   */
+  Vertex column(int c) const { return {m[c * 4], m[c * 4 + 1], m[c * 4 + 2]}; }
+  void set_column(int c, Vertex v) {
+    m[c * 4] = v.x;
+    m[c * 4 + 1] = v.y;
+    m[c * 4 + 2] = v.z;
+  }
+
+  bool is_identity() const { return *this == Matrix4(); }
+  bool operator==(const Matrix4 &other) const = default;
+};
+
 /**
  * @enum Response
  * @brief Ответ от модели во View.
@@ -94,7 +238,57 @@ using Polygons = std::vector<Triangle>;
 enum class Response {
   NormalDone,  // нужна перерисовка
   NothingUpdate,  // например, при повороте на 0 или 360 градусов
-  BadFile  // нет такого файла или файл не валидный
+  BadFile,  // нет такого файла или файл не валидный
+  Cancelled  // загрузка прервана пользователем
+};
+
+/**
+ * @struct Mesh_changes
+ * @brief Что изменилось в геометрии модели с прошлого запроса изменений.
+ *
+ * По нему отрисовка переписывает буфер вершин на месте, не выделяя его
+ * заново, а при смене топологии (числа вершин, полигонов, рёбер) передаёт
+ * всё заново. Сейчас геометрию меняют только bake() и reset(), и обе
+ * затрагивают все вершины, поэтому диапазон всегда — весь массив;
+ * mark_vertices() принимает и часть массива для будущих команд.
+ */
+struct Mesh_changes {
+  size_t vertices_from = 0; /**< Первая изменённая вершина. */
+  size_t vertices_to = 0;   /**< Вершина за последней изменённой. */
+  bool topology = false;    /**< Сменились полигоны или число вершин. */
+
+  /**
+   * @brief Добавляет к изменённым вершины [from, to).
+   */
+  void mark_vertices(size_t from, size_t to) {
+    if (from >= to) return;
+    if (vertices_from == vertices_to) {
+      vertices_from = from;
+      vertices_to = to;
+    } else {
+      vertices_from = std::min(vertices_from, from);
+      vertices_to = std::max(vertices_to, to);
+    }
+  }
+
+  bool empty() const { return !topology && vertices_from == vertices_to; }
+};
+
+class Load_preview;
+
+/**
+ * @struct Load_progress
+ * @brief Состояние загрузки модели, разделяемое с другим потоком.
+ *
+ * Парсер обновляет счётчики порциями, а интерфейс читает их для индикатора.
+ * Установка `cancelled` прерывает разбор на ближайшей границе порции.
+ */
+struct Load_progress {
+  std::atomic<uint64_t> bytes_total{0};  /**< Размер файла (0 — неизвестен). */
+  std::atomic<uint64_t> bytes_read{0};   /**< Разобрано байт. */
+  std::atomic<uint64_t> faces_parsed{0}; /**< Прочитано граней. */
+  std::atomic<bool> cancelled{false};    /**< Запрошена отмена. */
+  Load_preview *preview = nullptr;       /**< Частичный результат или nullptr. */
 };
 
 /**
@@ -0,0 +1,129 @@
+/**
+ * @file edges.cpp
+ * @brief Выделение уникальных рёбер из треугольников.
+ */
+
+#include "edges.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace s21 {
+
+namespace {
+
+// С какого числа треугольников рёбра собираются по корзинам (как
+// Model::kParallelThreshold для вершин)
+constexpr size_t kParallelTriangles = 1 << 18;
+
+// Сколько пар примерно в одной корзине: сортировка корзины — короткий
+// шаг, между которыми проверяется отмена
+constexpr size_t kBucketKeys = 1 << 20;
+
+// Треугольников в блоке одной задачи
+constexpr size_t kBlockTriangles = 1 << 14;
+
+}  // namespace
+
+Edges unique_edges(const Polygons &polygons, size_t vertex_count,
+                   Thread_pool *pool, const std::atomic<bool> *cancelled) {
+  auto stop = [cancelled] {
+    return cancelled && cancelled->load(std::memory_order_relaxed);
+  };
+  // Ребро (a, b) как одно число: сортировка идёт по a, затем по b
+  auto key = [](int a, int b) -> uint64_t {
+    if (a > b) std::swap(a, b);
+    return uint64_t(uint32_t(a)) << 32 | uint32_t(b);
+  };
+  auto edge = [](uint64_t k) {
+    return Edge{int(uint32_t(k >> 32)), int(uint32_t(k))};
+  };
+  size_t count = polygons.size();
+  Edges edges;
+  if (count < kParallelTriangles) {
+    std::vector<uint64_t> keys;
+    keys.reserve(count * 3);
+    for (const Triangle &t : polygons)
+      keys.insert(keys.end(),
+                  {key(t.v1, t.v2), key(t.v2, t.v3), key(t.v3, t.v1)});
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    edges.resize(keys.size());
+    std::transform(keys.begin(), keys.end(), edges.begin(), edge);
+    return edges;
+  }
+
+  // Задачи идут в пуле или по очереди в этом потоке; после отмены новые
+  // задачи не начинаются
+  auto run = [&](size_t tasks, auto &&task) {
+    if (pool) {
+      pool->run(tasks, [&](size_t i) {
+        if (!stop()) task(i);
+      });
+    } else {
+      for (size_t i = 0; i < tasks && !stop(); i++) task(i);
+    }
+  };
+
+  // Блоки треугольников того же размера, что и блоки вершин
+  size_t blocks = (count + kBlockTriangles - 1) / kBlockTriangles;
+  size_t buckets = std::max<size_t>(pool ? pool->size() * 4 : 1,
+                                    count * 3 / kBucketKeys + 1);
+  size_t range = vertex_count / buckets + 1;
+  auto bucket = [&](uint64_t k) {
+    return std::min<size_t>((k >> 32) / range, buckets - 1);
+  };
+  auto for_keys = [&](size_t b, auto &&op) {
+    size_t last = std::min(count, (b + 1) * kBlockTriangles);
+    for (size_t i = b * kBlockTriangles; i < last; i++) {
+      const Triangle &t = polygons[i];
+      op(key(t.v1, t.v2));
+      op(key(t.v2, t.v3));
+      op(key(t.v3, t.v1));
+    }
+  };
+
+  // Сколько пар каждый блок кладёт в каждую корзину
+  std::vector<size_t> offsets(blocks * buckets);
+  run(blocks, [&](size_t b) {
+    for_keys(b, [&](uint64_t k) { offsets[b * buckets + bucket(k)]++; });
+  });
+  if (stop()) return {};
+  // Корзины идут подряд, внутри корзины — по блокам
+  std::vector<size_t> begin(buckets + 1, 0);
+  for (size_t c = 0, total = 0; c < buckets; c++) {
+    for (size_t b = 0; b < blocks; b++) {
+      size_t n = offsets[b * buckets + c];
+      offsets[b * buckets + c] = total;
+      total += n;
+    }
+    begin[c + 1] = total;
+  }
+  std::vector<uint64_t> keys(begin[buckets]);
+  run(blocks, [&](size_t b) {
+    for_keys(b, [&](uint64_t k) {
+      keys[offsets[b * buckets + bucket(k)]++] = k;
+    });
+  });
+  if (stop()) return {};
+
+  // Корзина c после удаления повторов даёт рёбра [kept[c], kept[c + 1])
+  std::vector<size_t> kept(buckets + 1, 0);
+  run(buckets, [&](size_t c) {
+    auto first = keys.begin() + begin[c], last = keys.begin() + begin[c + 1];
+    std::sort(first, last);
+    kept[c + 1] = std::unique(first, last) - first;
+  });
+  if (stop()) return {};
+  for (size_t c = 0; c < buckets; c++) kept[c + 1] += kept[c];
+  edges.resize(kept[buckets]);
+  run(buckets, [&](size_t c) {
+    auto first = keys.begin() + begin[c];
+    std::transform(first, first + (kept[c + 1] - kept[c]),
+                   edges.begin() + kept[c], edge);
+  });
+  if (stop()) return {};
+  return edges;
+}
+
+}  // namespace s21
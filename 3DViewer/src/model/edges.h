@@ -0,0 +1,36 @@
+/**
+ * @file edges.h
+ * @brief Выделение уникальных рёбер из треугольников.
+ *
+ * Нужно и модели при загрузке, и упрощённым уровням детализации, поэтому
+ * не зависит от Model.
+ */
+
+#pragma once
+
+#include <atomic>
+
+#include "common.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @brief Уникальные рёбра треугольников по возрастанию (v1, v2).
+ * @param polygons Треугольники.
+ * @param vertex_count Число вершин (задаёт диапазоны корзин).
+ * @param pool Пул потоков или nullptr.
+ * @param cancelled Флаг отмены или nullptr.
+ * @return Рёбра; пусто, если работа отменена.
+ *
+ * Рёбра кодируются парой (меньший, больший индекс) и сортируются
+ * с удалением повторов. На больших моделях пары раскладываются по корзинам
+ * диапазонов меньшего индекса, и корзины сортируются по отдельности
+ * (в пуле — параллельно); результат тот же, что и одной сортировкой.
+ * Отмена проверяется между корзинами и блоками.
+ */
+Edges unique_edges(const Polygons &polygons, size_t vertex_count,
+                   Thread_pool *pool,
+                   const std::atomic<bool> *cancelled = nullptr);
+
+}  // namespace s21
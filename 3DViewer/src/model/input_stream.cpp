@@ -0,0 +1,249 @@
+/**
+ * @file input_stream.cpp
+ * @brief Реализация потокового чтения и распаковки .obj.
+ */
+
+#include "input_stream.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+
+#ifdef S21_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+/**
+ * @brief Несжатый файл, канал или стандартный ввод.
+ *
+ * Умеет заглядывать вперёд (peek), чтобы по сигнатуре выбрать распаковщик,
+ * не теряя прочитанные байты.
+ */
+class File_input : public Input_stream {
+ public:
+  File_input(int fd, bool owned) : fd_(fd), owned_(owned) {
+    struct stat st {};
+    if (::fstat(fd_, &st) == 0 && S_ISREG(st.st_mode)) size_ = st.st_size;
+  }
+  ~File_input() override {
+    if (owned_) ::close(fd_);
+  }
+
+  /**
+   * @brief Читает начало файла, не забирая его из потока.
+   * @param size Сколько байт нужно (меньше, если файл короче).
+   */
+  std::string_view peek(size_t size) {
+    while (head_.size() < size) {
+      char buffer[16];
+      size_t got =
+          raw_read(buffer, std::min(sizeof(buffer), size - head_.size()));
+      if (got == 0) break;
+      head_.append(buffer, got);
+    }
+    return head_;
+  }
+
+  size_t read(char *buffer, size_t size) override {
+    if (head_pos_ < head_.size()) {
+      size_t n = std::min(size, head_.size() - head_pos_);
+      std::memcpy(buffer, head_.data() + head_pos_, n);
+      head_pos_ += n;
+      return n;
+    }
+    return raw_read(buffer, size);
+  }
+
+  uint64_t consumed() const override { return consumed_; }
+  uint64_t source_size() const override { return size_; }
+
+ private:
+  size_t raw_read(char *buffer, size_t size) {
+    if (failed_) return 0;
+    for (;;) {
+      ssize_t got = ::read(fd_, buffer, size);
+      if (got < 0 && errno == EINTR) continue;
+      if (got < 0) {
+        failed_ = true;
+        return 0;
+      }
+      consumed_ += got;
+      return static_cast<size_t>(got);
+    }
+  }
+
+  int fd_;
+  bool owned_;
+  uint64_t size_ = 0;
+  uint64_t consumed_ = 0;
+  std::string head_;
+  size_t head_pos_ = 0;
+};
+
+/**
+ * @brief Распаковка gzip через zlib, включая склеенные архивы (`cat a.gz
+ * b.gz`).
+ */
+class Gzip_input : public Input_stream {
+ public:
+  explicit Gzip_input(std::unique_ptr<File_input> file)
+      : file_(std::move(file)), in_(kBlockSize) {
+    // 15 — максимальное окно, +32 — автоопределение заголовка gzip/zlib
+    failed_ = inflateInit2(&stream_, 15 + 32) != Z_OK;
+    initialized_ = !failed_;
+  }
+  ~Gzip_input() override {
+    if (initialized_) inflateEnd(&stream_);
+  }
+
+  size_t read(char *buffer, size_t size) override {
+    if (failed_ || done_) return 0;
+    size = std::min<size_t>(size, UINT_MAX);
+    stream_.next_out = reinterpret_cast<Bytef *>(buffer);
+    stream_.avail_out = static_cast<uInt>(size);
+    while (stream_.avail_out == size) {
+      if (stream_.avail_in == 0) {
+        size_t got = file_->read(in_.data(), in_.size());
+        if (got == 0) {
+          // Конец файла посреди архива — файл обрезан
+          failed_ = file_->failed() || !member_end_;
+          done_ = true;
+          break;
+        }
+        stream_.next_in = reinterpret_cast<Bytef *>(in_.data());
+        stream_.avail_in = static_cast<uInt>(got);
+      }
+      member_end_ = false;
+      int ret = inflate(&stream_, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END) {
+        member_end_ = true;
+        inflateReset(&stream_);
+      } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+        failed_ = true;
+        break;
+      }
+    }
+    return size - stream_.avail_out;
+  }
+
+  uint64_t consumed() const override { return file_->consumed(); }
+  uint64_t source_size() const override { return file_->source_size(); }
+
+ private:
+  std::unique_ptr<File_input> file_;
+  std::vector<char> in_;
+  z_stream stream_{};
+  bool initialized_ = false;
+  bool member_end_ = false;
+  bool done_ = false;
+};
+
+#ifdef S21_HAVE_ZSTD
+/**
+ * @brief Распаковка zstd через libzstd, включая несколько кадров подряд.
+ */
+class Zstd_input : public Input_stream {
+ public:
+  explicit Zstd_input(std::unique_ptr<File_input> file)
+      : file_(std::move(file)),
+        in_(kBlockSize),
+        stream_(ZSTD_createDStream()) {
+    failed_ = !stream_ || ZSTD_isError(ZSTD_initDStream(stream_));
+  }
+  ~Zstd_input() override { ZSTD_freeDStream(stream_); }
+
+  size_t read(char *buffer, size_t size) override {
+    if (failed_ || done_) return 0;
+    ZSTD_outBuffer out{buffer, size, 0};
+    while (out.pos == 0) {
+      if (input_.pos == input_.size) {
+        size_t got = file_->read(in_.data(), in_.size());
+        if (got == 0) {
+          // Ненулевой остаток — кадр не дочитан, файл обрезан
+          failed_ = file_->failed() || pending_ != 0;
+          done_ = true;
+          break;
+        }
+        input_ = {in_.data(), got, 0};
+      }
+      size_t ret = ZSTD_decompressStream(stream_, &out, &input_);
+      if (ZSTD_isError(ret)) {
+        failed_ = true;
+        break;
+      }
+      pending_ = ret;
+    }
+    return out.pos;
+  }
+
+  uint64_t consumed() const override { return file_->consumed(); }
+  uint64_t source_size() const override { return file_->source_size(); }
+
+ private:
+  std::unique_ptr<File_input> file_;
+  std::vector<char> in_;
+  ZSTD_DStream *stream_;
+  ZSTD_inBuffer input_{nullptr, 0, 0};
+  size_t pending_ = 1;
+  bool done_ = false;
+};
+#endif
+
+}  // namespace
+
+Compression detect_compression(std::string_view head) {
+  if (head.size() >= 2 && head[0] == '\x1f' && head[1] == '\x8b')
+    return Compression::Gzip;
+  if (head.size() >= 4 && head.substr(0, 4) == "\x28\xb5\x2f\xfd")
+    return Compression::Zstd;
+  return Compression::None;
+}
+
+Compression file_compression(const std::string &filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return Compression::None;
+  char head[4];
+  ssize_t size = ::pread(fd, head, sizeof(head), 0);
+  ::close(fd);
+  return detect_compression({head, size > 0 ? size_t(size) : 0});
+}
+
+bool compression_supported(Compression compression) {
+#ifdef S21_HAVE_ZSTD
+  return true;
+#else
+  return compression != Compression::Zstd;
+#endif
+}
+
+std::unique_ptr<Input_stream> Input_stream::open(const std::string &filename) {
+  bool from_stdin = filename == "-";
+  int fd = from_stdin ? STDIN_FILENO : ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  auto file = std::make_unique<File_input>(fd, !from_stdin);
+  Compression compression = detect_compression(file->peek(4));
+  if (!compression_supported(compression)) return nullptr;
+  switch (compression) {
+    case Compression::Gzip:
+      return std::make_unique<Gzip_input>(std::move(file));
+#ifdef S21_HAVE_ZSTD
+    case Compression::Zstd:
+      return std::make_unique<Zstd_input>(std::move(file));
+#endif
+    default:
+      return file;
+  }
+}
+
+}  // namespace s21
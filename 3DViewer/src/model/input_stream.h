@@ -0,0 +1,102 @@
+/**
+ * @file input_stream.h
+ * @brief Потоковое чтение .obj из файла, канала или сжатого архива.
+ *
+ * Позволяет парсеру читать `.obj.gz` и `.obj.zst` без распаковки на диск:
+ * данные распаковываются блоками фиксированного размера прямо в буфер
+ * парсера, поэтому расход памяти не зависит от размера файла.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace s21 {
+/**
+ * @enum Compression
+ * @brief Формат сжатия, определённый по первым байтам данных.
+ */
+enum class Compression {
+  None, /**< Несжатый текст. */
+  Gzip, /**< gzip (`1f 8b`). */
+  Zstd  /**< zstd (`28 b5 2f fd`). */
+};
+
+/**
+ * @brief Определяет формат сжатия по началу данных.
+ * @param head Первые байты файла (достаточно четырёх).
+ */
+Compression detect_compression(std::string_view head);
+
+/**
+ * @brief Определяет формат сжатия файла, прочитав только его начало.
+ * @param filename Путь к файлу; стандартный ввод не читается.
+ * @return Compression::None и для файла, который не удалось прочитать.
+ */
+Compression file_compression(const std::string &filename);
+
+/**
+ * @brief Поддерживается ли формат этой сборкой (zstd — только с libzstd).
+ */
+bool compression_supported(Compression compression);
+
+/**
+ * @class Input_stream
+ * @brief Источник байтов для построчного разбора.
+ *
+ * Реализации читают обычный файл или канал через `read(2)` и распаковывают
+ * gzip (zlib) и zstd (если сборка собрана с `S21_HAVE_ZSTD`). Сжатие
+ * определяется по сигнатуре, а не по расширению, поэтому работает и для
+ * стандартного ввода.
+ */
+class Input_stream {
+ public:
+  virtual ~Input_stream() = default;
+
+  /**
+   * @brief Открывает источник.
+   * @param filename Путь к файлу; `-` — стандартный ввод.
+   * @return nullptr, если файл не открывается или формат сжатия
+   * не поддерживается.
+   */
+  static std::unique_ptr<Input_stream> open(const std::string &filename);
+
+  /**
+   * @brief Читает следующую порцию (распакованных) данных.
+   * @param buffer Куда писать.
+   * @param size Размер буфера.
+   * @return Число прочитанных байт; 0 — данные закончились или ошибка.
+   */
+  virtual size_t read(char *buffer, size_t size) = 0;
+
+  /**
+   * @brief Была ли ошибка чтения или распаковки.
+   */
+  bool failed() const { return failed_; }
+
+  /**
+   * @brief Сколько байт прочитано из самого файла (до распаковки).
+   */
+  virtual uint64_t consumed() const = 0;
+
+  /**
+   * @brief Размер файла до распаковки (0 — неизвестен, например для канала).
+   */
+  virtual uint64_t source_size() const = 0;
+
+  /**
+   * @brief Размер блока чтения и распаковки (байт).
+   */
+  static constexpr size_t kBlockSize = 1 << 20;
+
+ protected:
+  /**
+   * @brief Признак ошибки чтения или распаковки.
+   */
+  bool failed_ = false;
+};
+}  // namespace s21
@@ -0,0 +1,83 @@
+/**
+ * @file load_preview.cpp
+ * @brief Реализация частичного результата загрузки.
+ */
+
+#include "load_preview.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace s21 {
+
+void Load_preview::append(std::span<const Vertex> vertices, const Faces &faces,
+                          size_t first_face) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (vertex_count_ == 0 && !vertices.empty()) min_ = max_ = vertices[0];
+  for (const auto &v : vertices) {
+    min_ = {std::min(min_.x, v.x), std::min(min_.y, v.y),
+            std::min(min_.z, v.z)};
+    max_ = {std::max(max_.x, v.x), std::max(max_.y, v.y),
+            std::max(max_.z, v.z)};
+  }
+  vertices_.insert(vertices_.end(), vertices.begin(), vertices.end());
+  vertex_count_ += vertices.size();
+
+  const long long count = vertex_count_;
+  size_t first_index = indices_.size();
+  for (size_t f = first_face; f < faces.size(); f++) {
+    std::span<const int> face = faces[f];
+    if (std::any_of(face.begin(), face.end(),
+                    [count](int idx) { return idx < 0 || idx >= count; }))
+      continue;
+    for (size_t i = 1; i + 1 < face.size(); i++) {
+      indices_.push_back(face[0]);
+      indices_.push_back(face[i]);
+      indices_.push_back(face[i + 1]);
+    }
+  }
+
+  // Ребро (a, b) как одно число, как в unique_edges()
+  std::vector<uint64_t> keys;
+  keys.reserve(indices_.size() - first_index);
+  for (size_t i = first_index; i + 2 < indices_.size(); i += 3) {
+    for (int j = 0; j < 3; j++) {
+      uint64_t a = indices_[i + j], b = indices_[i + (j + 1) % 3];
+      if (a > b) std::swap(a, b);
+      keys.push_back(a << 32 | b);
+    }
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  for (uint64_t k : keys) {
+    edges_.push_back(unsigned(k >> 32));
+    edges_.push_back(unsigned(k));
+  }
+}
+
+bool Load_preview::take(Preview_batch &batch) {
+  batch.vertices.clear();
+  batch.indices.clear();
+  batch.edges.clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (vertices_.empty() && indices_.empty()) return false;
+  // Обмен, а не копия: очищенные массивы читателя достаются парсеру
+  batch.vertices.swap(vertices_);
+  batch.indices.swap(indices_);
+  batch.edges.swap(edges_);
+  batch.center = (max_ + min_) / 2;
+  Vertex half = max_ - batch.center;
+  float absMax =
+      std::max({std::abs(half.x), std::abs(half.y), std::abs(half.z)});
+  batch.scale = absMax == 0.0f ? 1.0f : absMax / kNormalizationScale;
+  return true;
+}
+
+Preview_size Load_preview::estimate(uint64_t bytes) {
+  // Вершина и два её треугольника — около 30 + 2 · 25 байт
+  size_t vertices = bytes / 80;
+  return {vertices, vertices * 6, vertices * 6};
+}
+
+}  // namespace s21
@@ -0,0 +1,99 @@
+/**
+ * @file load_preview.h
+ * @brief Частичный результат загрузки для показа модели до конца разбора.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "common.h"
+
+namespace s21 {
+/**
+ * @struct Preview_batch
+ * @brief Новая часть предварительной модели, ещё не забранная интерфейсом.
+ */
+struct Preview_batch {
+  Vertices vertices;             /**< Вершины после прошлого чтения. */
+  std::vector<unsigned> indices; /**< Индексы новых треугольников. */
+  std::vector<unsigned> edges;   /**< Рёбра новых треугольников парами. */
+  Vertex center{};               /**< Предварительный центр модели. */
+  float scale = 1.0f;            /**< Предварительный делитель размера. */
+};
+
+/**
+ * @struct Preview_size
+ * @brief Примерный размер модели для заранее выделяемых буферов.
+ */
+struct Preview_size {
+  size_t vertices = 0; /**< Вершины. */
+  size_t indices = 0;  /**< Индексы треугольников. */
+  size_t edges = 0;    /**< Индексы рёбер (по два на ребро). */
+};
+
+/**
+ * @class Load_preview
+ * @brief Передача уже разобранной части модели из парсера в интерфейс.
+ *
+ * Парсер дописывает сюда новые вершины и грани по мере разбора, а
+ * интерфейс в своём потоке забирает их и сразу дописывает в буферы
+ * видеокарты. Забранное здесь не остаётся: кроме массивов парсера, в
+ * памяти лежат только порции, ещё не показанные интерфейсом.
+ * Многоугольники разбиваются веером, грани со ссылкой на ещё не
+ * прочитанную вершину пропускаются. Рёбра новых треугольников собираются
+ * здесь же, в потоке парсера, без повторов внутри порции; ребро на
+ * границе двух порций передаётся дважды.
+ *
+ * Нормализация предварительная: центр и масштаб считаются по рамке уже
+ * прочитанных вершин и уточняются с каждой порцией. Сами вершины
+ * передаются без изменений, поэтому смена нормализации не требует их
+ * перезаписи.
+ */
+class Load_preview {
+ public:
+  /**
+   * @brief Дописывает порцию разобранных данных.
+   * @param vertices Новые вершины (продолжают уже добавленные).
+   * @param faces Грани с индексами от нуля в общей нумерации вершин.
+   * @param first_face Номер первой ещё не добавленной грани в `faces`.
+   */
+  void append(std::span<const Vertex> vertices, const Faces &faces,
+              size_t first_face);
+
+  /**
+   * @brief Забирает данные, добавленные после прошлого вызова.
+   * @param batch Куда переносятся новые вершины, индексы и нормализация;
+   * прежние массивы `batch` очищаются и переиспользуются парсером.
+   * @return false, если ничего нового нет.
+   */
+  bool take(Preview_batch &batch);
+
+  /**
+   * @brief Примерный размер модели по размеру файла.
+   * @param bytes Размер файла .obj (для сжатого — сжатый размер).
+   *
+   * Строка вершины занимает около 30 байт, строка грани — около 25,
+   * а треугольников у сетки примерно вдвое больше, чем вершин. Для
+   * сжатого файла или файла с нормалями и текстурными координатами
+   * оценка промахивается, и буферы дорастают по ходу загрузки.
+   */
+  static Preview_size estimate(uint64_t bytes);
+
+ private:
+  /**
+   * @brief Коэффициент масштабирования (как у Model::normalization()).
+   */
+  static constexpr float kNormalizationScale = 0.9f;
+
+  std::mutex mutex_;
+  Vertices vertices_;              // Ещё не забранные вершины
+  std::vector<unsigned> indices_;  // Ещё не забранные индексы
+  std::vector<unsigned> edges_;    // Ещё не забранные рёбра
+  size_t vertex_count_ = 0;        // Сколько вершин добавлено всего
+  Vertex min_{}, max_{};
+};
+}  // namespace s21
@@ -0,0 +1,35 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Реализация отображения файла в память (POSIX `mmap`).
+ */
+
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace s21 {
+
+Mapped_file::Mapped_file(const std::string &filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return;
+  struct stat st {};
+  if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void *addr = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED) {
+      ::madvise(addr, size, MADV_SEQUENTIAL);
+      data_ = static_cast<const char *>(addr);
+      size_ = size;
+    }
+  }
+  ::close(fd);
+}
+
+Mapped_file::~Mapped_file() {
+  if (data_) ::munmap(const_cast<char *>(data_), size_);
+}
+
+}  // namespace s21
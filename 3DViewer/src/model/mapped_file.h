@@ -0,0 +1,56 @@
+/**
+ * @file mapped_file.h
+ * @brief Отображение файла в память только для чтения.
+ *
+ * Позволяет парсеру обходить содержимое .obj-файла без копирования строк:
+ * весь файл доступен как один непрерывный `std::string_view`.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace s21 {
+/**
+ * @class Mapped_file
+ * @brief RAII-обёртка над `mmap` для обычных файлов.
+ *
+ * Если файл нельзя отобразить (канал, пустой файл, устройство, нет прав),
+ * объект остаётся закрытым, а вызывающий код переходит на потоковое чтение.
+ */
+class Mapped_file {
+ public:
+  /**
+   * @brief Отображает файл в память.
+   * @param filename Путь к файлу.
+   */
+  explicit Mapped_file(const std::string &filename);
+  ~Mapped_file();
+
+  Mapped_file(const Mapped_file &) = delete;
+  Mapped_file &operator=(const Mapped_file &) = delete;
+
+  /**
+   * @brief Удалось ли отобразить файл.
+   */
+  bool is_open() const { return data_ != nullptr; }
+
+  /**
+   * @brief Содержимое файла (пустое, если файл не отображён).
+   */
+  std::string_view view() const { return {data_, size_}; }
+
+ private:
+  /**
+   * @brief Начало отображённой области.
+   */
+  const char *data_ = nullptr;
+
+  /**
+   * @brief Размер отображённой области в байтах.
+   */
+  std::size_t size_ = 0;
+};
+}  // namespace s21
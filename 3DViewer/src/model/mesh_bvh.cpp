@@ -0,0 +1,243 @@
+/**
+ * @file mesh_bvh.cpp
+ * @brief Построение и пересчёт BVH над треугольниками модели.
+ */
+
+#include "mesh_bvh.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace s21 {
+
+namespace {
+
+// Владелец не найден: элемент идёт после всех листьев
+constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+// Выполняет task(0) … task(count - 1) в пуле или последовательно
+void parallel_for(Thread_pool *pool, size_t count,
+                  const std::function<void(size_t)> &task) {
+  if (pool && count > 1)
+    pool->run(count, task);
+  else
+    for (size_t i = 0; i < count; i++) task(i);
+}
+
+// Записывает value в a, если оно меньше текущего значения
+void atomic_min(std::atomic<uint32_t> &a, uint32_t value) {
+  uint32_t current = a.load(std::memory_order_relaxed);
+  while (value < current &&
+         !a.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+  }
+}
+
+void extend(Vertex &min, Vertex &max, const Vertex &v) {
+  min = {std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z)};
+  max = {std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z)};
+}
+
+// Раскладывает элементы по группам-владельцам с сохранением порядка внутри
+// группы. Возвращает новое место каждого элемента; start[g] — начало
+// группы g, группа `groups` собирает элементы без владельца.
+std::vector<uint32_t> group_by_owner(
+    const std::vector<std::atomic<uint32_t>> &owner, size_t groups,
+    std::vector<uint32_t> &start) {
+  auto group = [&](size_t i) {
+    return std::min<size_t>(owner[i].load(std::memory_order_relaxed), groups);
+  };
+  start.assign(groups + 2, 0);
+  for (size_t i = 0; i < owner.size(); i++) start[group(i) + 1]++;
+  for (size_t g = 0; g <= groups; g++) start[g + 1] += start[g];
+  std::vector<uint32_t> next(start.begin(), start.end() - 1);
+  std::vector<uint32_t> position(owner.size());
+  for (size_t i = 0; i < owner.size(); i++) position[i] = next[group(i)]++;
+  return position;
+}
+
+}  // namespace
+
+void Mesh_bvh::clear() {
+  nodes_.clear();
+  levels_.clear();
+  leaves_.clear();
+  points_.clear();
+}
+
+void Mesh_bvh::assign(std::vector<Bvh_node> nodes, std::vector<int> points) {
+  clear();
+  nodes_ = std::move(nodes);
+  points_ = std::move(points);
+  if (nodes_.empty()) return;
+  // Тот же обход, что в make_node(): уровни и листья в том же порядке
+  std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+  while (!stack.empty()) {
+    auto [id, depth] = stack.back();
+    stack.pop_back();
+    if (levels_.size() <= depth) levels_.resize(depth + 1);
+    levels_[depth].push_back(id);
+    const Bvh_node &node = nodes_[id];
+    if (node.leaf()) {
+      leaves_.push_back(id);
+      continue;
+    }
+    stack.push_back({node.right, depth + 1});
+    stack.push_back({node.left, depth + 1});
+  }
+}
+
+int Mesh_bvh::make_node(uint32_t from, uint32_t count, size_t depth) {
+  int id = nodes_.size();
+  nodes_.emplace_back();
+  nodes_[id].triangles_from = from;
+  nodes_[id].triangles_to = from + count;
+  if (levels_.size() <= depth) levels_.resize(depth + 1);
+  levels_[depth].push_back(id);
+  if (count <= kClusterTriangles) {
+    leaves_.push_back(id);
+    return id;
+  }
+  uint32_t half = count / 2;
+  int left = make_node(from, half, depth + 1);
+  int right = make_node(from + half, count - half, depth + 1);
+  nodes_[id].left = left;
+  nodes_[id].right = right;
+  return id;
+}
+
+void Mesh_bvh::build(const Vertices &vertices, Polygons &polygons,
+                     Edges &edges, Thread_pool *pool) {
+  clear();
+  size_t count = polygons.size();
+  if (count == 0) return;
+  make_node(0, count, 0);
+  size_t blocks = (count + kClusterTriangles - 1) / kClusterTriangles;
+  auto for_triangles = [&](const std::function<void(size_t)> &op) {
+    parallel_for(pool, blocks, [&](size_t b) {
+      size_t last = std::min(count, (b + 1) * kClusterTriangles);
+      for (size_t i = b * kClusterTriangles; i < last; i++) op(i);
+    });
+  };
+
+  // Утроенные центры треугольников: для деления важен только порядок
+  Vertices centers(count);
+  for_triangles([&](size_t i) {
+    const Triangle &t = polygons[i];
+    centers[i] = vertices[t.v1] + vertices[t.v2] + vertices[t.v3];
+  });
+
+  // Каждый узел делит свой диапазон пополам по самой длинной оси; узлы
+  // одного уровня не пересекаются и делятся параллельно
+  std::vector<uint32_t> order(count);
+  std::iota(order.begin(), order.end(), 0);
+  for (const auto &level : levels_) {
+    parallel_for(pool, level.size(), [&](size_t n) {
+      const Bvh_node &node = nodes_[level[n]];
+      if (node.leaf()) return;
+      auto first = order.begin() + node.triangles_from;
+      auto last = order.begin() + node.triangles_to;
+      Vertex min = centers[*first], max = min;
+      for (auto it = first; it != last; ++it) extend(min, max, centers[*it]);
+      Vertex size = max - min;
+      float Vertex::*axis = size.x >= size.y && size.x >= size.z ? &Vertex::x
+                            : size.y >= size.z                   ? &Vertex::y
+                                                                 : &Vertex::z;
+      std::nth_element(first, first + (last - first) / 2, last,
+                       [&](uint32_t a, uint32_t b) {
+                         return centers[a].*axis < centers[b].*axis;
+                       });
+    });
+  }
+  centers = {};
+  Polygons sorted(count);
+  for_triangles([&](size_t i) { sorted[i] = polygons[order[i]]; });
+  polygons.swap(sorted);
+  sorted = {};
+  order = {};
+
+  // Владелец ребра и вершины — первый лист с их треугольником
+  size_t leaves = leaves_.size();
+  std::vector<std::atomic<uint32_t>> edge_owner(edges.size());
+  std::vector<std::atomic<uint32_t>> point_owner(vertices.size());
+  for (auto &owner : edge_owner) owner.store(kNone, std::memory_order_relaxed);
+  for (auto &owner : point_owner)
+    owner.store(kNone, std::memory_order_relaxed);
+  auto less = [](const Edge &a, const Edge &b) {
+    return a.v1 < b.v1 || (a.v1 == b.v1 && a.v2 < b.v2);
+  };
+  parallel_for(pool, leaves, [&](size_t l) {
+    auto own_edge = [&](int a, int b) {
+      Edge key = a < b ? Edge{a, b} : Edge{b, a};
+      auto it = std::lower_bound(edges.begin(), edges.end(), key, less);
+      if (it != edges.end() && *it == key)
+        atomic_min(edge_owner[it - edges.begin()], l);
+    };
+    const Bvh_node &leaf = nodes_[leaves_[l]];
+    for (uint32_t i = leaf.triangles_from; i < leaf.triangles_to; i++) {
+      const Triangle &t = polygons[i];
+      own_edge(t.v1, t.v2);
+      own_edge(t.v2, t.v3);
+      own_edge(t.v3, t.v1);
+      for (int v : {t.v1, t.v2, t.v3}) atomic_min(point_owner[v], l);
+    }
+  });
+
+  std::vector<uint32_t> edge_start, point_start;
+  std::vector<uint32_t> position = group_by_owner(edge_owner, leaves,
+                                                  edge_start);
+  Edges grouped(edges.size());
+  for (size_t e = 0; e < edges.size(); e++) grouped[position[e]] = edges[e];
+  edges.swap(grouped);
+  position = group_by_owner(point_owner, leaves, point_start);
+  points_.resize(vertices.size());
+  for (size_t v = 0; v < vertices.size(); v++) points_[position[v]] = v;
+
+  for (size_t l = 0; l < leaves; l++) {
+    Bvh_node &leaf = nodes_[leaves_[l]];
+    leaf.edges_from = edge_start[l];
+    leaf.edges_to = edge_start[l + 1];
+    leaf.points_from = point_start[l];
+    leaf.points_to = point_start[l + 1];
+  }
+  for (auto level = levels_.rbegin(); level != levels_.rend(); ++level) {
+    for (int id : *level) {
+      Bvh_node &node = nodes_[id];
+      if (node.leaf()) continue;
+      node.edges_from = nodes_[node.left].edges_from;
+      node.edges_to = nodes_[node.right].edges_to;
+      node.points_from = nodes_[node.left].points_from;
+      node.points_to = nodes_[node.right].points_to;
+    }
+  }
+  refit(vertices, polygons, pool);
+}
+
+void Mesh_bvh::refit(const Vertices &vertices, const Polygons &polygons,
+                     Thread_pool *pool) {
+  parallel_for(pool, leaves_.size(), [&](size_t l) {
+    Bvh_node &leaf = nodes_[leaves_[l]];
+    Vertex min = vertices[polygons[leaf.triangles_from].v1], max = min;
+    for (uint32_t i = leaf.triangles_from; i < leaf.triangles_to; i++) {
+      const Triangle &t = polygons[i];
+      for (int v : {t.v1, t.v2, t.v3}) extend(min, max, vertices[v]);
+    }
+    leaf.min = min;
+    leaf.max = max;
+  });
+  for (auto level = levels_.rbegin(); level != levels_.rend(); ++level) {
+    for (int id : *level) {
+      Bvh_node &node = nodes_[id];
+      if (node.leaf()) continue;
+      node.min = nodes_[node.left].min;
+      node.max = nodes_[node.left].max;
+      extend(node.min, node.max, nodes_[node.right].min);
+      extend(node.min, node.max, nodes_[node.right].max);
+    }
+  }
+}
+
+}  // namespace s21
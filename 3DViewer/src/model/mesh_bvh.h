@@ -0,0 +1,134 @@
+/**
+ * @file mesh_bvh.h
+ * @brief Иерархия ограничивающих объёмов (BVH) над треугольниками модели.
+ *
+ * Нужна отрисовке, чтобы отбрасывать части модели вне поля зрения: каждый
+ * кадр рамки узлов проверяются по пирамиде видимости, и рисуются только
+ * видимые кластеры.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common.h"
+#include "thread_pool.h"
+
+namespace s21 {
+
+/**
+ * @struct Bvh_node
+ * @brief Узел BVH.
+ *
+ * Треугольники, рёбра и точки модели переупорядочены так, что всё
+ * относящееся к узлу лежит непрерывными диапазонами [from, to), а
+ * диапазоны потомков идут подряд: сначала левый, затем правый.
+ */
+struct Bvh_node {
+  Vertex min;     /**< Рамка треугольников узла (координаты модели). */
+  Vertex max;     /**< Рамка треугольников узла (координаты модели). */
+  int left = -1;  /**< Левый потомок; -1 у листа. */
+  int right = -1; /**< Правый потомок; -1 у листа. */
+  uint32_t triangles_from = 0; /**< Треугольники узла в polygons. */
+  uint32_t triangles_to = 0;
+  uint32_t edges_from = 0; /**< Рёбра узла в edges. */
+  uint32_t edges_to = 0;
+  uint32_t points_from = 0; /**< Вершины узла в Mesh_bvh::points(). */
+  uint32_t points_to = 0;
+
+  bool leaf() const { return left < 0; }
+  bool operator==(const Bvh_node &other) const = default;
+};
+
+/**
+ * @class Mesh_bvh
+ * @brief Строит BVH над треугольниками и группирует по нему рёбра и точки.
+ *
+ * Узел делится пополам по числу треугольников вдоль самой длинной оси
+ * рамки их центров, пока в листе (кластере) больше kClusterTriangles
+ * треугольников. Форма дерева зависит только от числа треугольников,
+ * поэтому узлы одного уровня делятся параллельно, а результат не зависит
+ * от числа потоков.
+ */
+class Mesh_bvh {
+ public:
+  /**
+   * @brief Наибольшее число треугольников в листе.
+   */
+  static constexpr size_t kClusterTriangles = 4096;
+
+  /**
+   * @brief Строит дерево и переупорядочивает под него геометрию.
+   * @param vertices Вершины модели.
+   * @param polygons Треугольники; переставляются по листьям.
+   * @param edges Уникальные рёбра по возрастанию (см. Model::extractEdges);
+   * группируются по листьям, внутри листа порядок сохраняется.
+   * @param pool Пул потоков или nullptr.
+   *
+   * Ребро и вершина относятся к первому по порядку листу, треугольник
+   * которого их содержит. Вершины без треугольников идут в points() после
+   * всех листьев.
+   */
+  void build(const Vertices &vertices, Polygons &polygons, Edges &edges,
+             Thread_pool *pool);
+
+  /**
+   * @brief Пересчитывает рамки узлов после изменения вершин.
+   * @param vertices Вершины модели (их число не меняется).
+   * @param polygons Треугольники в порядке, заданном build().
+   * @param pool Пул потоков или nullptr.
+   */
+  void refit(const Vertices &vertices, const Polygons &polygons,
+             Thread_pool *pool);
+
+  /**
+   * @brief Восстанавливает дерево, сохранённое из nodes() и points(),
+   * без перестройки и перестановки геометрии.
+   * @param nodes Узлы в порядке build() (корень первый, потомки в глубину
+   * слева направо).
+   * @param points Индексы вершин, сгруппированные по листьям.
+   *
+   * Используется кэшем модели: треугольники и рёбра лежат в нём уже
+   * в порядке дерева.
+   */
+  void assign(std::vector<Bvh_node> nodes, std::vector<int> points);
+
+  void clear();
+
+  /**
+   * @brief Пусто ли дерево (у модели нет треугольников).
+   */
+  bool empty() const { return nodes_.empty(); }
+
+  /**
+   * @brief Узлы дерева; корень — nodes()[0].
+   */
+  const std::vector<Bvh_node> &nodes() const { return nodes_; }
+
+  /**
+   * @brief Индексы вершин, сгруппированные по листьям.
+   */
+  const std::vector<int> &points() const { return points_; }
+
+ private:
+  /**
+   * @brief Добавляет узел для треугольников [from, from + count) и его
+   * потомков.
+   * @return Номер узла.
+   */
+  int make_node(uint32_t from, uint32_t count, size_t depth);
+
+  std::vector<Bvh_node> nodes_;
+  /**
+   * @brief Номера узлов по уровням, от корня.
+   */
+  std::vector<std::vector<int>> levels_;
+  /**
+   * @brief Листья в порядке их диапазонов.
+   */
+  std::vector<int> leaves_;
+  std::vector<int> points_;
+};
+
+}  // namespace s21
@@ -0,0 +1,286 @@
+/**
+ * @file mesh_cache.cpp
+ * @brief Реализация двоичного кэша модели.
+ *
+ * Раскладка файла (порядок байтов — родной для машины):
+ * заголовок, путь к исходному файлу (выровнен до 8 байт), смещения
+ * многоугольников (uint64), вершины (3 × float), треугольники (3 × int32),
+ * индексы многоугольников (int32), рёбра (2 × int32), узлы BVH (Bvh_node),
+ * вершины листьев BVH (int32).
+ */
+
+#include "mesh_cache.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+
+#include "mapped_file.h"
+
+namespace s21 {
+
+namespace {
+
+static_assert(sizeof(Vertex) == 3 * sizeof(float) &&
+              std::is_trivially_copyable_v<Vertex>);
+static_assert(sizeof(Triangle) == 3 * sizeof(int) &&
+              std::is_trivially_copyable_v<Triangle>);
+static_assert(sizeof(Edge) == 2 * sizeof(int) &&
+              std::is_trivially_copyable_v<Edge>);
+static_assert(std::is_trivially_copyable_v<Bvh_node>);
+static_assert(sizeof(size_t) == sizeof(uint64_t));
+
+constexpr char kMagic[8] = {'S', '2', '1', 'M', 'E', 'S', 'H', '\0'};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t path_size;
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t fingerprint;
+  uint64_t vertex_count;
+  uint64_t triangle_count;
+  uint64_t face_count;
+  uint64_t face_index_count;
+  uint64_t edge_count;
+  uint64_t node_count;
+  uint64_t point_count;
+};
+static_assert(sizeof(Header) % 8 == 0);
+
+/**
+ * @brief Описание исходного файла, с которым сверяется кэш.
+ */
+struct Source_key {
+  std::string path;
+  uint64_t size = 0;
+  int64_t mtime = 0;
+  uint64_t fingerprint = 0;
+};
+
+uint64_t fnv1a(std::string_view data, uint64_t hash = 14695981039346656037ull) {
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+size_t align8(size_t n) { return (n + 7) & ~size_t(7); }
+
+/**
+ * @brief Отпечаток содержимого: хэш 16 равномерно взятых блоков по 4 КБ.
+ *
+ * Читает не более 64 КБ независимо от размера файла, поэтому не замедляет
+ * открытие, но ловит правку файла с сохранением размера и времени.
+ */
+uint64_t fingerprint(const std::string &source) {
+  constexpr size_t kBlock = 4096, kSamples = 16;
+  Mapped_file mapped(source);
+  std::string_view data = mapped.view();
+  uint64_t hash = fnv1a({});
+  if (data.size() <= kBlock * kSamples) return fnv1a(data, hash);
+  for (size_t i = 0; i < kSamples; i++) {
+    size_t pos = (data.size() - kBlock) * i / (kSamples - 1);
+    hash = fnv1a(data.substr(pos, kBlock), hash);
+  }
+  return hash;
+}
+
+bool source_key(const std::string &source, Source_key &key) {
+  namespace fs = std::filesystem;
+  std::error_code ec;
+  fs::path path = fs::absolute(source, ec);
+  if (ec || !fs::is_regular_file(path, ec)) return false;
+  key.path = path.lexically_normal().string();
+  key.size = fs::file_size(path, ec);
+  if (ec) return false;
+  key.mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+  if (ec) return false;
+  key.fingerprint = fingerprint(source);
+  return true;
+}
+
+size_t data_size(const Header &h) {
+  return align8(h.path_size) + (h.face_count + 1) * sizeof(size_t) +
+         h.vertex_count * sizeof(Vertex) + h.triangle_count * sizeof(Triangle) +
+         h.face_index_count * sizeof(int) + h.edge_count * sizeof(Edge) +
+         h.node_count * sizeof(Bvh_node) + h.point_count * sizeof(int);
+}
+
+template <typename T>
+void read_array(const char *&ptr, std::vector<T> &out, size_t count) {
+  out.resize(count);
+  if (count) std::memcpy(out.data(), ptr, count * sizeof(T));
+  ptr += count * sizeof(T);
+}
+
+template <typename T>
+void write_array(std::ofstream &out, const std::vector<T> &data) {
+  out.write(reinterpret_cast<const char *>(data.data()),
+            data.size() * sizeof(T));
+}
+
+}  // namespace
+
+Mesh_cache::Mesh_cache(std::string dir, uint64_t limit)
+    : dir_(std::move(dir)), limit_(limit) {}
+
+std::string Mesh_cache::path_for(const std::string &source) const {
+  if (dir_.empty()) return source + ".s21mesh";
+  std::error_code ec;
+  std::string abs = std::filesystem::absolute(source, ec).string();
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.s21mesh",
+                static_cast<unsigned long long>(fnv1a(ec ? source : abs)));
+  return (std::filesystem::path(dir_) / name).string();
+}
+
+bool Mesh_cache::load(const std::string &source, Vertices &vertices,
+                      Polygons &polygons, Faces &raw_polygons, Edges &edges,
+                      Mesh_bvh &bvh) const {
+  Source_key key;
+  if (!source_key(source, key)) return false;
+  std::string path = path_for(source);
+  Mapped_file mapped(path);
+  std::string_view data = mapped.view();
+  if (data.size() < sizeof(Header)) return false;
+
+  Header h;
+  std::memcpy(&h, data.data(), sizeof(Header));
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 ||
+      h.version != kVersion || h.source_size != key.size ||
+      h.source_mtime != key.mtime || h.fingerprint != key.fingerprint ||
+      h.path_size != key.path.size() ||
+      data.size() != sizeof(Header) + data_size(h) ||
+      data.substr(sizeof(Header), h.path_size) != key.path)
+    return false;
+
+  const char *ptr = data.data() + sizeof(Header) + align8(h.path_size);
+  Faces faces;
+  Vertices points;
+  Polygons triangles;
+  Edges unique;
+  std::vector<Bvh_node> nodes;
+  std::vector<int> groups;
+  read_array(ptr, faces.offsets, h.face_count + 1);
+  read_array(ptr, points, h.vertex_count);
+  read_array(ptr, triangles, h.triangle_count);
+  read_array(ptr, faces.indices, h.face_index_count);
+  read_array(ptr, unique, h.edge_count);
+  read_array(ptr, nodes, h.node_count);
+  read_array(ptr, groups, h.point_count);
+  // Потомки идут после родителя (см. Mesh_bvh::assign()): испорченный
+  // файл не должен зациклить обход дерева
+  for (size_t i = 0; i < nodes.size(); i++) {
+    const Bvh_node &node = nodes[i];
+    if (!node.leaf() && (node.left <= int(i) || node.right <= int(i) ||
+                         size_t(node.left) >= nodes.size() ||
+                         size_t(node.right) >= nodes.size()))
+      return false;
+  }
+  raw_polygons = std::move(faces);
+  vertices = std::move(points);
+  polygons = std::move(triangles);
+  edges = std::move(unique);
+  bvh.assign(std::move(nodes), std::move(groups));
+  // Время изменения — время последнего использования для evict()
+  std::error_code ec;
+  std::filesystem::last_write_time(
+      path, std::filesystem::file_time_type::clock::now(), ec);
+  return true;
+}
+
+bool Mesh_cache::save(const std::string &source, const Vertices &vertices,
+                      const Polygons &polygons, const Faces &raw_polygons,
+                      const Edges &edges, const Mesh_bvh &bvh) const {
+  Source_key key;
+  if (!source_key(source, key)) return false;
+  std::error_code ec;
+  if (!dir_.empty()) std::filesystem::create_directories(dir_, ec);
+
+  Header h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion;
+  h.path_size = key.path.size();
+  h.source_size = key.size;
+  h.source_mtime = key.mtime;
+  h.fingerprint = key.fingerprint;
+  h.vertex_count = vertices.size();
+  h.triangle_count = polygons.size();
+  h.face_count = raw_polygons.size();
+  h.face_index_count = raw_polygons.indices.size();
+  h.edge_count = edges.size();
+  h.node_count = bvh.nodes().size();
+  h.point_count = bvh.points().size();
+  bool limited = limit_ > 0 && !dir_.empty();
+  if (limited && sizeof(Header) + data_size(h) > limit_) return false;
+
+  std::string path = path_for(source);
+  // Другие экземпляры программы и потоки могут сохранять ту же модель:
+  // у каждой записи свой временный файл, целиком заменяющий кэш при rename
+  static std::atomic<unsigned> saves{0};
+  std::string tmp = path + "." + std::to_string(::getpid()) + "." +
+                    std::to_string(saves++) + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char *>(&h), sizeof(Header));
+    out.write(key.path.data(), key.path.size());
+    const char padding[8] = {};
+    out.write(padding, align8(key.path.size()) - key.path.size());
+    write_array(out, raw_polygons.offsets);
+    write_array(out, vertices);
+    write_array(out, polygons);
+    write_array(out, raw_polygons.indices);
+    write_array(out, edges);
+    write_array(out, bvh.nodes());
+    write_array(out, bvh.points());
+    if (!out) {
+      out.close();
+      std::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+  std::filesystem::rename(tmp, path, ec);
+  bool saved = !ec;
+  if (!saved) std::filesystem::remove(tmp, ec);
+  if (saved && limited) evict(path);
+  return saved;
+}
+
+void Mesh_cache::evict(const std::string &keep) const {
+  namespace fs = std::filesystem;
+  struct Entry {
+    fs::file_time_type used;
+    uint64_t size;
+    fs::path path;
+  };
+  std::vector<Entry> entries;
+  uint64_t total = 0;
+  std::error_code ec;
+  for (const auto &file : fs::directory_iterator(dir_, ec)) {
+    if (file.path().extension() != ".s21mesh") continue;
+    Entry entry{file.last_write_time(ec), file.file_size(ec), file.path()};
+    if (ec) continue;
+    total += entry.size;
+    if (!fs::equivalent(entry.path, keep, ec)) entries.push_back(entry);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return a.used < b.used; });
+  for (const Entry &entry : entries) {
+    if (total <= limit_) break;
+    if (fs::remove(entry.path, ec)) total -= entry.size;
+  }
+}
+
+}  // namespace s21
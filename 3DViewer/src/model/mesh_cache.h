@@ -0,0 +1,103 @@
+/**
+ * @file mesh_cache.h
+ * @brief Двоичный кэш подготовленной модели (.s21mesh).
+ *
+ * Хранит нормализованные вершины, треугольники, исходные многоугольники,
+ * рёбра и BVH, чтобы повторное открытие того же .obj-файла не требовало ни
+ * разбора текста, ни сборки рёбер и дерева.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common.h"
+#include "mesh_bvh.h"
+
+namespace s21 {
+/**
+ * @class Mesh_cache
+ * @brief Чтение и запись файлов кэша .s21mesh.
+ *
+ * Файл кэша лежит рядом с исходным (`model.obj.s21mesh`) или в отдельном
+ * каталоге под именем, полученным из хэша пути. Кэш действителен, только
+ * если совпадают версия формата, путь, размер, время изменения и отпечаток
+ * содержимого исходного файла; иначе он игнорируется и перезаписывается.
+ *
+ * Размер отдельного каталога можно ограничить: после записи из него
+ * удаляются файлы кэша, дольше всех не использованные (LRU). Время
+ * использования — время изменения файла, которое обновляет каждое
+ * успешное чтение.
+ *
+ * Загрузка — отображение файла в память, проверка заголовка и копирование
+ * массивов в модель, которая ими владеет. Треугольники и рёбра лежат
+ * в порядке BVH, и дерево восстанавливается как есть, поэтому ничего не
+ * пересчитывается и не сортируется.
+ */
+class Mesh_cache {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param dir Каталог кэша; пустая строка — хранить рядом с исходным файлом.
+   * @param limit Наибольший общий размер файлов кэша в `dir` в байтах;
+   * 0 — без ограничения. Рядом с исходными файлами не действует.
+   */
+  explicit Mesh_cache(std::string dir = "", uint64_t limit = 0);
+
+  /**
+   * @brief Путь к файлу кэша для исходного файла.
+   * @param source Путь к .obj-файлу.
+   */
+  std::string path_for(const std::string &source) const;
+
+  /**
+   * @brief Загружает модель из кэша.
+   * @param source Путь к .obj-файлу.
+   * @param vertices Нормализованные вершины.
+   * @param polygons Треугольники (включая триангулированные многоугольники).
+   * @param raw_polygons Многоугольники из четырёх и более вершин.
+   * @param edges Уникальные рёбра, сгруппированные по листьям `bvh`.
+   * @param bvh Дерево над треугольниками.
+   * @return false, если кэша нет или он устарел; выходные данные не меняются.
+   */
+  bool load(const std::string &source, Vertices &vertices, Polygons &polygons,
+            Faces &raw_polygons, Edges &edges, Mesh_bvh &bvh) const;
+
+  /**
+   * @brief Записывает модель в кэш.
+   * @return false, если записать не удалось (например, каталог только для
+   * чтения).
+   *
+   * Запись идёт во временный файл, который затем переименовывается, поэтому
+   * другой процесс не увидит недописанный кэш. Модель больше ограничения
+   * размера не записывается.
+   */
+  bool save(const std::string &source, const Vertices &vertices,
+            const Polygons &polygons, const Faces &raw_polygons,
+            const Edges &edges, const Mesh_bvh &bvh) const;
+
+  /**
+   * @brief Версия формата; увеличивается при любом изменении раскладки.
+   */
+  static constexpr uint32_t kVersion = 2;
+
+ private:
+  /**
+   * @brief Каталог кэша (пустой — рядом с исходным файлом).
+   */
+  std::string dir_;
+
+  /**
+   * @brief Ограничение размера каталога в байтах (0 — нет).
+   */
+  uint64_t limit_;
+
+  /**
+   * @brief Удаляет самые давно использованные файлы кэша, пока каталог
+   * больше ограничения.
+   * @param keep Только что записанный файл; не удаляется.
+   */
+  void evict(const std::string &keep) const;
+};
+}  // namespace s21
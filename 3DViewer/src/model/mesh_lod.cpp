@@ -0,0 +1,292 @@
+/**
+ * @file mesh_lod.cpp
+ * @brief Упрощение модели по квадрикам ошибки.
+ */
+
+#include "mesh_lod.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <tuple>
+
+#include "edges.h"
+
+namespace s21 {
+
+namespace {
+
+// Как часто проверяется отмена (в треугольниках)
+constexpr size_t kCancelStep = 1 << 16;
+
+// Сколько раз уточняется сетка уровня, давшего слишком много треугольников
+constexpr int kResolutionAttempts = 3;
+
+/**
+ * @brief Квадрика ошибки: сумма квадратов расстояний до плоскостей.
+ *
+ * Хранится верхний треугольник симметричной матрицы 4×4 плоскостей
+ * (a, b, c, d): aa ab ac ad bb bc bd cc cd dd. Внутри ячейки складываются
+ * единицы треугольников, поэтому float хватает и экономит память.
+ */
+struct Quadric {
+  std::array<float, 10> q{};
+
+  void add_plane(double a, double b, double c, double d, double weight) {
+    const double p[4] = {a, b, c, d};
+    for (int i = 0, k = 0; i < 4; i++)
+      for (int j = i; j < 4; j++) q[k++] += weight * p[i] * p[j];
+  }
+
+  /**
+   * @brief Точка минимума ошибки.
+   * @return false, если плоскости не задают точку (плоский или
+   * цилиндрический участок).
+   */
+  bool minimum(Vertex &point) const {
+    double a11 = q[0], a12 = q[1], a13 = q[2], b1 = -q[3];
+    double a22 = q[4], a23 = q[5], b2 = -q[6];
+    double a33 = q[7], b3 = -q[8];
+    double c11 = a22 * a33 - a23 * a23;
+    double c12 = a13 * a23 - a12 * a33;
+    double c13 = a12 * a23 - a13 * a22;
+    double det = a11 * c11 + a12 * c12 + a13 * c13;
+    double trace = a11 + a22 + a33;
+    if (!(std::abs(det) > 1e-6 * trace * trace * trace)) return false;
+    double c22 = a11 * a33 - a13 * a13;
+    double c23 = a12 * a13 - a11 * a23;
+    double c33 = a11 * a22 - a12 * a12;
+    point = {float((c11 * b1 + c12 * b2 + c13 * b3) / det),
+             float((c12 * b1 + c22 * b2 + c23 * b3) / det),
+             float((c13 * b1 + c23 * b2 + c33 * b3) / det)};
+    return true;
+  }
+};
+
+/**
+ * @brief Сортировка раскладкой по корзинам, прерываемая отменой.
+ * @param items Сортируемые элементы.
+ * @param buckets Число корзин.
+ * @param bucket Корзина элемента, меньше buckets; корзины идут в порядке
+ * less.
+ * @param less Порядок внутри корзины.
+ * @param cancelled Проверка отмены.
+ * @return false, если сортировка прервана (items тогда не определён).
+ *
+ * Элементы раскладываются подсчётом, и каждая корзина сортируется
+ * отдельно: отмена проверяется через каждые kCancelStep элементов, а не
+ * после одной длинной std::sort.
+ */
+template <typename T, typename Bucket, typename Less, typename Cancelled>
+bool bucket_sort(std::vector<T> &items, size_t buckets, Bucket bucket,
+                 Less less, Cancelled cancelled) {
+  std::vector<size_t> begin(buckets + 1, 0);
+  for (const T &item : items) begin[bucket(item) + 1]++;
+  for (size_t b = 0; b < buckets; b++) begin[b + 1] += begin[b];
+  if (cancelled()) return false;
+  std::vector<T> sorted(items.size());
+  std::vector<size_t> next(begin.begin(), begin.end() - 1);
+  for (const T &item : items) sorted[next[bucket(item)]++] = item;
+  next = {};
+  for (size_t b = 0, done = 0; b < buckets; b++) {
+    auto first = sorted.begin() + begin[b];
+    auto last = sorted.begin() + begin[b + 1];
+    std::sort(first, last, less);
+    done += last - first;
+    if (done >= kCancelStep) {
+      if (cancelled()) return false;
+      done = 0;
+    }
+  }
+  items.swap(sorted);
+  return true;
+}
+
+}  // namespace
+
+Lod_levels Mesh_simplifier::build(const Vertices &vertices,
+                                  const Polygons &polygons) const {
+  Lod_levels levels;
+  if (polygons.size() < kMinTriangles) return levels;
+  // Поверхность в сетке R×R×R занимает порядка R² ячеек, и каждая ячейка
+  // даёт около двух треугольников: для T треугольников R ≈ √(T / 6)
+  double resolution = std::sqrt(polygons.size() / 6.0);
+  const Vertices *from_vertices = &vertices;
+  const Polygons *from_polygons = &polygons;
+  size_t target = polygons.size() / kLevelRatio;
+  while (target >= kCoarsestTriangles) {
+    resolution *= std::sqrt(double(target) / from_polygons->size());
+    Lod_level level;
+    for (int attempt = 0; attempt < kResolutionAttempts; attempt++) {
+      level = simplify(*from_vertices, *from_polygons,
+                       std::max(1, int(std::lround(resolution))));
+      if (cancelled()) return {};
+      size_t count = level.polygons.size();
+      if (count == 0 || count <= target * 2) break;
+      resolution *= std::sqrt(double(target) / count);
+    }
+    // Сетка не уменьшает модель: дальше упрощать нечего
+    if (level.polygons.empty() ||
+        level.polygons.size() * 2 > from_polygons->size())
+      break;
+    level.edges = unique_edges(level.polygons, level.vertices.size(), nullptr,
+                               cancelled_);
+    if (cancelled()) return {};
+    levels.push_back(std::move(level));
+    from_vertices = &levels.back().vertices;
+    from_polygons = &levels.back().polygons;
+    // Следующий уровень заказывается от достигнутого, а не от заказанного
+    target = from_polygons->size() / kLevelRatio;
+  }
+  return levels;
+}
+
+Lod_level Mesh_simplifier::simplify(const Vertices &vertices,
+                                    const Polygons &polygons,
+                                    int resolution) const {
+  Lod_level level;
+  if (polygons.empty()) return level;
+
+  // Сетка строится по рамке вершин, входящих в треугольники
+  std::vector<bool> used(vertices.size());
+  for (const Triangle &t : polygons)
+    used[t.v1] = used[t.v2] = used[t.v3] = true;
+  constexpr float kInf = std::numeric_limits<float>::infinity();
+  Vertex min{kInf, kInf, kInf}, max{-kInf, -kInf, -kInf};
+  for (size_t v = 0; v < vertices.size(); v++) {
+    if (!used[v]) continue;
+    const Vertex &p = vertices[v];
+    min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+    max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+  }
+  float size = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+  float cell = size > 0 ? size / resolution : 1.0f;
+
+  // Ячейка каждой вершины: ключи ячеек сортируются, номер ячейки —
+  // место её ключа
+  auto coord = [&](float x, float from) {
+    return uint64_t(std::clamp(int((x - from) / cell), 0, resolution - 1));
+  };
+  auto key = [&](const Vertex &p) {
+    return (coord(p.x, min.x) * resolution + coord(p.y, min.y)) *
+               resolution +
+           coord(p.z, min.z);
+  };
+  std::vector<uint64_t> cells;
+  for (size_t v = 0; v < vertices.size(); v++)
+    if (used[v]) cells.push_back(key(vertices[v]));
+  if (cells.empty() || cancelled()) return {};
+  // Корзины — равные отрезки ключей, в среднем по нескольку ячеек
+  auto [low, high] = std::minmax_element(cells.begin(), cells.end());
+  uint64_t first_key = *low;
+  size_t cell_buckets = cells.size() / 16 + 1;
+  uint64_t width = (*high - first_key) / cell_buckets + 1;
+  if (!bucket_sort(
+          cells, cell_buckets,
+          [&](uint64_t k) { return size_t((k - first_key) / width); },
+          std::less<uint64_t>(), [this] { return cancelled(); }))
+    return {};
+  cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+  std::vector<int> cell_of(vertices.size(), -1);
+  for (size_t v = 0; v < vertices.size(); v++) {
+    if (v % kCancelStep == 0 && cancelled()) return {};
+    if (!used[v]) continue;
+    auto it = std::lower_bound(cells.begin(), cells.end(), key(vertices[v]));
+    cell_of[v] = it - cells.begin();
+  }
+  used = {};
+
+  // Квадрики плоскостей треугольников с весом площади и средние точки
+  std::vector<Quadric> quadrics(cells.size());
+  Vertices sums(cells.size(), Vertex{0, 0, 0});
+  std::vector<uint32_t> counts(cells.size());
+  for (size_t v = 0; v < vertices.size(); v++) {
+    int c = cell_of[v];
+    if (c < 0) continue;
+    sums[c] = sums[c] + vertices[v];
+    counts[c]++;
+  }
+  for (size_t i = 0; i < polygons.size(); i++) {
+    if (i % kCancelStep == 0 && cancelled()) return {};
+    const Triangle &t = polygons[i];
+    const Vertex &p1 = vertices[t.v1];
+    Vertex e1 = vertices[t.v2] - p1, e2 = vertices[t.v3] - p1;
+    double nx = double(e1.y) * e2.z - double(e1.z) * e2.y;
+    double ny = double(e1.z) * e2.x - double(e1.x) * e2.z;
+    double nz = double(e1.x) * e2.y - double(e1.y) * e2.x;
+    double length = std::sqrt(nx * nx + ny * ny + nz * nz);
+    if (length == 0) continue;
+    nx /= length;
+    ny /= length;
+    nz /= length;
+    double d = -(nx * p1.x + ny * p1.y + nz * p1.z);
+    // Вес — площадь треугольника; в каждую его ячейку по одному разу
+    int c1 = cell_of[t.v1], c2 = cell_of[t.v2], c3 = cell_of[t.v3];
+    double area = length / 2;
+    quadrics[c1].add_plane(nx, ny, nz, d, area);
+    if (c2 != c1) quadrics[c2].add_plane(nx, ny, nz, d, area);
+    if (c3 != c1 && c3 != c2) quadrics[c3].add_plane(nx, ny, nz, d, area);
+  }
+
+  // Вершина ячейки — минимум квадрики, если он недалеко от вершин ячейки,
+  // иначе их среднее
+  Vertices points(cells.size());
+  for (size_t c = 0; c < cells.size(); c++) {
+    Vertex mean = sums[c] / float(counts[c]);
+    Vertex best{};
+    bool keep = quadrics[c].minimum(best);
+    if (keep) {
+      Vertex offset = best - mean;
+      keep = offset.x * offset.x + offset.y * offset.y + offset.z * offset.z <=
+             cell * cell;
+    }
+    points[c] = keep ? best : mean;
+  }
+  quadrics = {};
+  sums = {};
+  if (cancelled()) return {};
+
+  // Треугольники с тремя разными ячейками, без повторов; поворот к
+  // наименьшему индексу сохраняет направление обхода
+  for (const Triangle &t : polygons) {
+    Triangle r = {cell_of[t.v1], cell_of[t.v2], cell_of[t.v3]};
+    if (r.v1 == r.v2 || r.v2 == r.v3 || r.v3 == r.v1) continue;
+    while (r.v1 > r.v2 || r.v1 > r.v3) r = {r.v2, r.v3, r.v1};
+    level.polygons.push_back(r);
+  }
+  if (cancelled()) return {};
+  // Повороты уже начинаются с наименьшего индекса: корзина — v1
+  auto tie = [](const Triangle &t) { return std::tie(t.v1, t.v2, t.v3); };
+  if (!bucket_sort(
+          level.polygons, cells.size(),
+          [](const Triangle &t) { return size_t(t.v1); },
+          [&](const Triangle &a, const Triangle &b) {
+            return tie(a) < tie(b);
+          },
+          [this] { return cancelled(); }))
+    return {};
+  level.polygons.erase(
+      std::unique(level.polygons.begin(), level.polygons.end(),
+                  [&](const Triangle &a, const Triangle &b) {
+                    return tie(a) == tie(b);
+                  }),
+      level.polygons.end());
+
+  // Ячейки без треугольников (стянутые целиком) не нужны
+  std::vector<int> remap(cells.size(), -1);
+  for (const Triangle &t : level.polygons)
+    remap[t.v1] = remap[t.v2] = remap[t.v3] = 0;
+  for (size_t c = 0; c < cells.size(); c++) {
+    if (remap[c] < 0) continue;
+    remap[c] = level.vertices.size();
+    level.vertices.push_back(points[c]);
+  }
+  for (Triangle &t : level.polygons)
+    t = {remap[t.v1], remap[t.v2], remap[t.v3]};
+  return level;
+}
+
+}  // namespace s21
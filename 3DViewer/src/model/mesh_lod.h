@@ -0,0 +1,95 @@
+/**
+ * @file mesh_lod.h
+ * @brief Упрощённые копии модели (уровни детализации) для показа издалека.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "common.h"
+
+namespace s21 {
+
+/**
+ * @struct Lod_level
+ * @brief Одна упрощённая копия модели в тех же координатах, что и модель.
+ */
+struct Lod_level {
+  Vertices vertices; /**< Вершины уровня. */
+  Polygons polygons; /**< Треугольники уровня. */
+  Edges edges;       /**< Уникальные рёбра (см. unique_edges()). */
+};
+
+using Lod_levels = std::vector<Lod_level>;
+
+/**
+ * @class Mesh_simplifier
+ * @brief Строит уровни детализации по квадрикам ошибки (QEM).
+ *
+ * Вершины объединяются по ячейкам равномерной сетки, а место вершины
+ * ячейки выбирается минимумом суммы квадрик плоскостей её треугольников
+ * (метод Линдстрома). В отличие от поочерёдного стягивания рёбер это один
+ * проход по треугольникам без очереди, поэтому годится для моделей
+ * в десятки миллионов треугольников. Острые края и углы сохраняются:
+ * квадрика тянет вершину к пересечению плоскостей граней.
+ */
+class Mesh_simplifier {
+ public:
+  /**
+   * @brief С какого числа треугольников модели нужны уровни.
+   */
+  static constexpr size_t kMinTriangles = 1 << 19;
+
+  /**
+   * @brief Ниже какого числа треугольников уровни больше не строятся.
+   */
+  static constexpr size_t kCoarsestTriangles = 1 << 17;
+
+  /**
+   * @brief Во сколько раз каждый уровень меньше предыдущего.
+   */
+  static constexpr size_t kLevelRatio = 4;
+
+  /**
+   * @brief Конструктор.
+   * @param cancelled Флаг отмены, проверяемый по ходу работы (может быть
+   * nullptr).
+   */
+  explicit Mesh_simplifier(const std::atomic<bool> *cancelled = nullptr)
+      : cancelled_(cancelled) {}
+
+  /**
+   * @brief Строит уровни от подробного к грубому.
+   * @param vertices Вершины модели.
+   * @param polygons Треугольники модели.
+   * @return Уровни, каждый примерно в kLevelRatio раз меньше предыдущего,
+   * последний — не меньше kCoarsestTriangles. Пусто, если модель меньше
+   * kMinTriangles или сборка отменена.
+   *
+   * Каждый уровень строится из предыдущего; шаг сетки подбирается по
+   * тому, сколько треугольников дал прошлый шаг.
+   */
+  Lod_levels build(const Vertices &vertices, const Polygons &polygons) const;
+
+  /**
+   * @brief Упрощает модель одной сеткой.
+   * @param vertices Вершины.
+   * @param polygons Треугольники.
+   * @param resolution Число ячеек сетки вдоль самой длинной стороны рамки.
+   * @return Упрощённая модель без рёбер; треугольники, стянутые в отрезок
+   * или точку, и повторы отбрасываются.
+   */
+  Lod_level simplify(const Vertices &vertices, const Polygons &polygons,
+                     int resolution) const;
+
+ private:
+  bool cancelled() const {
+    return cancelled_ && cancelled_->load(std::memory_order_relaxed);
+  }
+
+  const std::atomic<bool> *cancelled_;
+};
+
+}  // namespace s21
@@ -9,10 +9,13 @@
 
 #include "model.h"
 
+#include <algorithm>
 #include <memory>
 
+#include "edges.h"
 #include "parser.h"
 #include "rotate_strategy.h"
+#include "vertex_kernels.h"
 
 namespace s21 {
 
@@ -20,27 +23,56 @@ Model::Model() = default;
 
 void Model::translate(Vertex direction, bool defValue) {
   if (defValue) direction = direction * kMoveStep;
-  for (auto &v : vertices) v = v + direction;
+  transform.translate(direction);
 }
 
 void Model::scale(float f, bool zoomOut) {
   if (!f) f = kScaleStep;
   if (zoomOut) f = 1 / f;
-  for (auto &point : vertices) {
-    point = point * f;
+  transform.scale(f);
+}
+
+void Model::bake() {
+  if (transform.is_identity()) return;
+  if (!original_) original_ = vertices;
+  for_blocks([this](std::span<Vertex> block) {
+    Vertex_kernels::transform(block, transform);
+  });
+  transform = Matrix4();
+  bvh.refit(vertices, polygons, pool_.get());
+  geometry_version_++;
+  changes_.mark_vertices(0, vertices.size());
+}
+
+void Model::reset() {
+  transform = Matrix4();
+  if (original_) {
+    vertices = std::move(*original_);
+    original_.reset();
+    bvh.refit(vertices, polygons, pool_.get());
+    geometry_version_++;
+    changes_.mark_vertices(0, vertices.size());
   }
 }
 
 void Model::normalization() {
-  Vertex center = {0.0f, 0.0f, 0.0f};
-  float mx = std::numeric_limits<float>::lowest();
-  float mn = std::numeric_limits<float>::max();
-  Vertex max = {mx, mx, mx};
-  Vertex min = {mn, mn, mn};
-  for (const auto &v : vertices) {
-    max = {std::max(max.x, v.x), std::max(max.y, v.y), std::max(max.z, v.z)};
-    min = {std::min(min.x, v.x), std::min(min.y, v.y), std::min(min.z, v.z)};
-  }
+  Vertex center;
+  float divisor = normalization_divisor(center);
+  transform.translate(center * -1.0f);
+  transform.scale(1 / divisor);
+}
+
+void Model::normalize_vertices() {
+  Vertex center;
+  float divisor = normalization_divisor(center);
+  for_blocks([center, divisor](std::span<Vertex> block) {
+    Vertex_kernels::normalize(block, center, divisor);
+  });
+}
+
+float Model::normalization_divisor(Vertex &center) const {
+  Vertex max, min;
+  bounds(min, max);
   center = (max + min) / 2;
   max = max - center;
   min = min - center;
@@ -51,29 +83,114 @@ void Model::normalization() {
     absMax = 1;
   else
     absMax = absMax / kNormalizationScale;
-  for (auto &v : vertices) v = (v - center) / absMax;
+  return absMax;
 }
 
-void Model::openModel(const std::string fname) {
+void Model::for_blocks(const std::function<void(std::span<Vertex>)> &op) {
+  size_t count = vertices.size();
+  if (!pool_ || count < kParallelThreshold) {
+    op(vertices);
+    return;
+  }
+  std::span<Vertex> all(vertices);
+  pool_->run((count + kBlockVertices - 1) / kBlockVertices, [&](size_t b) {
+    size_t first = b * kBlockVertices;
+    op(all.subspan(first, std::min(kBlockVertices, count - first)));
+  });
+}
+
+void Model::bounds(Vertex &min, Vertex &max) const {
+  size_t count = vertices.size();
+  if (transform.is_identity() && (!pool_ || count < kParallelThreshold)) {
+    Vertex_kernels::bounds(vertices, min, max);
+    return;
+  }
+  std::span<const Vertex> all(vertices);
+  size_t blocks = (count + kBlockVertices - 1) / kBlockVertices;
+  Vertices mins(blocks), maxs(blocks);
+  auto block_bounds = [&](size_t b) {
+    size_t first = b * kBlockVertices;
+    auto block = all.subspan(first, std::min(kBlockVertices, count - first));
+    if (transform.is_identity()) {
+      Vertex_kernels::bounds(block, mins[b], maxs[b]);
+      return;
+    }
+    // Вершины не меняются: преобразуется копия блока
+    thread_local Vertices moved;
+    moved.assign(block.begin(), block.end());
+    Vertex_kernels::transform(moved, transform);
+    Vertex_kernels::bounds(moved, mins[b], maxs[b]);
+  };
+  if (pool_ && count >= kParallelThreshold)
+    pool_->run(blocks, block_bounds);
+  else
+    for (size_t b = 0; b < blocks; b++) block_bounds(b);
+  // min и max коммутативны, поэтому порядок блоков не меняет результат
+  Vertex unused;
+  Vertex_kernels::bounds(mins, min, unused);
+  Vertex_kernels::bounds(maxs, unused, max);
+}
+
+void Model::setCache(bool enabled, const std::string &dir, uint64_t limit) {
+  if (enabled)
+    cache_.emplace(dir, limit);
+  else
+    cache_.reset();
+}
+
+void Model::copySettings(const Model &other) {
+  cache_ = other.cache_;
+  pool_ = other.pool_;
+}
+
+void Model::setThreads(unsigned threads) {
+  if (threads > 1)
+    pool_ = std::make_shared<Thread_pool>(threads);
+  else
+    pool_.reset();
+}
+
+void Model::openModel(const std::string fname, unsigned threads,
+                      Load_progress *progress) {
+  transform = Matrix4();
+  original_.reset();
+  changes_ = {};
+  changes_.topology = true;
+  unsaved_source_.clear();
+  if (cache_ &&
+      cache_->load(fname, vertices, polygons, raw_polygons, edges, bvh)) {
+    response = Response::NormalDone;
+    return;
+  }
   Parser parser;
-  parser.initParser(fname);
+  parser.initParser(fname, threads, progress);
   response = parser.response;
-  vertices = parser.vertices;
-  polygons = parser.polygons;
-  raw_polygons = parser.raw_polygons;
-  if (response != Response::BadFile) {
-    normalization();
-    if (raw_polygons.size() > 0) triangulation(parser.raw_polygons);
+  vertices = std::move(parser.vertices);
+  polygons = std::move(parser.polygons);
+  raw_polygons = std::move(parser.raw_polygons);
+  if (response == Response::NormalDone) {
+    normalize_vertices();
+    if (raw_polygons.size() > 0) triangulation(raw_polygons);
   } else {
     vertices.clear();
     polygons.clear();
     raw_polygons.clear();
   }
+  extractEdges();
+  bvh.build(vertices, polygons, edges, pool_.get());
+  // В кэш пойдут треугольники и рёбра уже в порядке дерева
+  if (cache_ && response == Response::NormalDone) unsaved_source_ = fname;
 }
 
-void Model::triangulation(std::vector<std::vector<int>> raw_polygons) {
-  polygons.reserve(polygons.size() + raw_polygons.size() * 2);
-  for (auto &rp : raw_polygons) {
+void Model::extractEdges() {
+  edges = unique_edges(polygons, vertices.size(), pool_.get());
+}
+
+void Model::triangulation(const Faces &raw_polygons) {
+  polygons.reserve(polygons.size() + raw_polygons.indices.size() -
+                   raw_polygons.size() * 2);
+  for (size_t f = 0; f < raw_polygons.size(); f++) {
+    std::span<const int> rp = raw_polygons[f];
     for (size_t i = 0; i < rp.size() - 2; i++) {
       Triangle triangle = {rp[0], rp[i + 1], rp[i + 2]};
       polygons.push_back(triangle);
@@ -81,43 +198,19 @@ void Model::triangulation(std::vector<std::vector<int>> raw_polygons) {
   }
 }
 
-Axis Model::parse_angle(Vertex rotate_param, float *angle) {
-  Axis axis = uninitalized;
-  if (rotate_param.x != 0) {
-    *angle = rotate_param.x;
-    axis = X;
-  } else if (rotate_param.y != 0) {
-    *angle = rotate_param.y;
-    axis = Y;
-  } else if (rotate_param.z != 0) {
-    *angle = rotate_param.z;
-    axis = Z;
-  }
-  return axis;
-}
-
 void Model::rotate(Vertex rotate_param, bool defValue) {
-  float angle = 0;
   if (defValue) rotate_param = rotate_param * kRotAngle;
-  Axis axis = parse_angle(rotate_param, &angle);
-  if (axis != uninitalized) {
-    std::unique_ptr<Rotate_strategy> strategy;
-
-    switch (axis) {
-      case X:
-        strategy = std::make_unique<RotateX>(angle);
-        break;
-      case Y:
-        strategy = std::make_unique<RotateY>(angle);
-        break;
-      case Z:
-        strategy = std::make_unique<RotateZ>(angle);
-        break;
-      default:
-        return;
-    }
-    Apply_rotation_strategy affin_transform(strategy.get());
-    affin_transform.apply_rotation(vertices);
-  }
+  if (rotate_param.x == 0 && rotate_param.y == 0 && rotate_param.z == 0)
+    return;
+  RotateComposite strategy = RotateComposite::euler(rotate_param);
+  rotate(strategy);
+}
+
+void Model::rotate(Rotate_strategy &strategy) {
+  Vertices columns = {transform.column(0), transform.column(1),
+                      transform.column(2), transform.column(3)};
+  Apply_rotation_strategy affin_transform(&strategy);
+  affin_transform.apply_rotation(columns);
+  for (int c = 0; c < 4; c++) transform.set_column(c, columns[c]);
 }
 }  // namespace s21
\ No newline at end of file
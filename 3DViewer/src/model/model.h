@@ -11,11 +11,19 @@
 #include <cstdio>
 #include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <random>
 #include <sstream>
+#include <utility>
 
 #include "common.h"
+#include "mesh_bvh.h"
+#include "mesh_cache.h"
+#include "rotate_strategy.h"
+#include "thread_pool.h"
 
 namespace s21 {
 
@@ -46,7 +54,33 @@ class Model {
   /**
    * @brief Исходные (сырые) полигоны модели до триангуляции.
    */
-  std::vector<std::vector<int>> raw_polygons;
+  Faces raw_polygons;
+
+  /**
+   * @brief Уникальные рёбра треугольников.
+   *
+   * Общее ребро соседних треугольников входит один раз, поэтому каркас
+   * рисуется без повторов, а размер списка — настоящее число рёбер.
+   * Рёбра сгруппированы по листьям bvh.
+   */
+  Edges edges;
+
+  /**
+   * @brief BVH над polygons для отсечения невидимых частей модели.
+   *
+   * Строится при загрузке, переставляя polygons и edges; bake() и reset()
+   * только пересчитывают рамки узлов.
+   */
+  Mesh_bvh bvh;
+
+  /**
+   * @brief Накопленное преобразование модели.
+   *
+   * Сдвиг, масштаб и поворот меняют только матрицу, а не вершины: её
+   * применяет при отрисовке видеокарта. В вершины она переносится только
+   * явно, через bake(); reset() возвращает исходную геометрию.
+   */
+  Matrix4 transform;
 
  private:
   /**
@@ -69,9 +103,21 @@ class Model {
    */
   static constexpr float kRotAngle = 10.0f;
 
+  /**
+   * @brief С какого числа вершин bake() и normalization() идут параллельно.
+   *
+   * На меньших моделях запуск задач в пуле дороже самой работы.
+   */
+  static constexpr size_t kParallelThreshold = 1 << 18;
+
+  /**
+   * @brief Размер блока вершин одной задачи (192 КиБ — помещается в L2).
+   */
+  static constexpr size_t kBlockVertices = 1 << 14;
+
  public:
   /**
-   * @brief Перемещает модель на заданный вектор.
+   * @brief Перемещает модель на заданный вектор (меняет transform).
    * @param direction Вектор смещения.
    * @param defValue Если true — direction умножается на фиксированную
    * величину.
@@ -79,44 +125,203 @@ class Model {
   void translate(Vertex direction, bool defValue);
 
   /**
-   * @brief Масштабирует модель.
+   * @brief Масштабирует модель (меняет transform).
    * @param f Коэффициент масштабирования.
    * @param zoomOut Если true — используется обратный коэффициент (1 / f).
    */
   void scale(float f, bool zoomOut);
 
   /**
-   * @brief Определяет ось вращения и угол.
-   * @param rotate_param Вектор с ненулевым компонентом (ось + угол).
-   * @param angle Указатель, куда записывается значение угла.
-   * @return Ось вращения.
+   * @brief Выполняет поворот модели (меняет transform).
+   * @param rotate_param Углы Эйлера в градусах: сначала X, затем Y, затем Z.
+   * @param defValue Если true — масштабирует угол на фиксированную величину.
+   *
+   * Все три угла применяются одной матрицей (RotateComposite::euler).
    */
-  Axis parse_angle(Vertex rotate_param, float *angle);
+  void rotate(Vertex rotate_param, bool defValue);
 
   /**
-   * @brief Выполняет поворот модели.
-   * @param rotate_param Параметр поворота (вектор с углом по оси).
-   * @param defValue Если true — масштабирует угол на фиксированную величину.
+   * @brief Дописывает поворот стратегией к transform.
+   * @param strategy Стратегия вращения, например RotateComposite.
    */
-  void rotate(Vertex rotate_param, bool defValue);
+  void rotate(Rotate_strategy &strategy);
 
   /**
    * @brief Центрирует и нормализует размер модели.
+   *
+   * Рамка считается по вершинам с учётом transform, а сдвиг и масштаб
+   * дописываются в transform; сами вершины не меняются.
    */
   void normalization();
 
+  /**
+   * @brief Применяет накопленное преобразование к вершинам и сбрасывает его.
+   *
+   * Перед первым изменением вершин сохраняет их копию для reset().
+   */
+  void bake();
+
+  /**
+   * @brief Возвращает модель к состоянию сразу после загрузки.
+   *
+   * Сбрасывает transform и, если вершины менялись через bake(),
+   * восстанавливает сохранённую копию. Файл заново не читается.
+   */
+  void reset();
+
+  /**
+   * @brief Менялись ли вершины с момента загрузки (через bake()).
+   *
+   * Если нет, reset() меняет только transform и вершины не нужно заново
+   * передавать на видеокарту.
+   */
+  bool isBaked() const { return original_.has_value(); }
+
+  /**
+   * @brief Счётчик изменений вершин: растёт при каждом bake() и при
+   * восстановлении вершин в reset().
+   *
+   * Позволяет отличить команды, менявшие только transform.
+   */
+  uint64_t geometryVersion() const { return geometry_version_; }
+
+  /**
+   * @brief Возвращает накопленные изменения геометрии и сбрасывает их.
+   *
+   * Загрузка отмечает смену топологии, bake() и восстановление в reset()
+   * — изменённые вершины. Преобразования transform сюда не попадают.
+   */
+  Mesh_changes takeChanges() { return std::exchange(changes_, {}); }
+
   /**
    * @brief Загружает модель из файла.
    * @param fname Путь к файлу.
+   * @param threads Число потоков разбора файла.
+   * @param progress Счётчики прогресса и флаг отмены (может быть nullptr).
+   *
+   * Если включён кэш и для файла есть действительный .s21mesh, модель
+   * берётся из него без разбора. Иначе разобранная модель только
+   * помечается для записи в кэш: сама запись идёт вне загрузки (см.
+   * takeUnsavedSource()).
+   */
+  void openModel(const std::string fname, unsigned threads = 1,
+                 Load_progress *progress = nullptr);
+
+  /**
+   * @brief Переносит настройки (кэш) другой модели, не трогая геометрию.
+   * @param other Модель-источник настроек.
+   *
+   * Используется при фоновой загрузке, когда новая модель собирается
+   * отдельно от текущей.
+   */
+  void copySettings(const Model &other);
+
+  /**
+   * @brief Включает или выключает двоичный кэш моделей.
+   * @param enabled Использовать ли кэш.
+   * @param dir Каталог кэша; пустая строка — рядом с исходным файлом.
+   * @param limit Наибольший размер каталога кэша в байтах; 0 — без
+   * ограничения (см. Mesh_cache).
+   */
+  void setCache(bool enabled, const std::string &dir = "",
+                uint64_t limit = 0);
+
+  /**
+   * @brief Забирает путь файла, разобранного openModel() и ещё не
+   * записанного в кэш.
+   * @return Путь или пустая строка, если кэш выключен, модель взята из
+   * кэша или путь уже забран.
+   */
+  std::string takeUnsavedSource() { return std::exchange(unsaved_source_, {}); }
+
+  /**
+   * @brief Текущий кэш моделей (пусто, если выключен).
+   *
+   * Копия не зависит от модели, поэтому запись в неё может идти в другом
+   * потоке, пока кэш модели переключают (см. Controller::saveCacheAsync()).
+   */
+  const std::optional<Mesh_cache> &cache() const { return cache_; }
+
+  /**
+   * @brief Задаёт число потоков для bake() и normalization().
+   * @param threads Число потоков; 0 и 1 — последовательная обработка.
+   *
+   * Вершины делятся на блоки по kBlockVertices, рамка считается
+   * параллельной редукцией. Результат побитово совпадает с
+   * последовательным: каждая вершина обрабатывается теми же операциями.
+   */
+  void setThreads(unsigned threads);
+
+  /**
+   * @brief Строит edges по polygons.
+   *
+   * Вызывается при загрузке; рёбра собирает unique_edges() в пуле модели.
    */
-  void openModel(const std::string fname);
+  void extractEdges();
 
  private:
+  /**
+   * @brief Кэш подготовленных моделей (по умолчанию выключен).
+   */
+  std::optional<Mesh_cache> cache_;
+
+  /**
+   * @brief Файл, разобранный последним и ещё не записанный в кэш.
+   */
+  std::string unsaved_source_;
+
+  /**
+   * @brief Пул потоков (nullptr — последовательная обработка).
+   *
+   * Общий для копий модели, в том числе для загружаемой в фоне.
+   */
+  std::shared_ptr<Thread_pool> pool_;
+
+  /**
+   * @brief Применяет операцию к вершинам целиком или поблочно в пуле.
+   * @param op Операция над непрерывным участком вершин.
+   */
+  void for_blocks(const std::function<void(std::span<Vertex>)> &op);
+
+  /**
+   * @brief Рамка вершин после transform (параллельная редукция на больших
+   * моделях); вершины не меняются.
+   */
+  void bounds(Vertex &min, Vertex &max) const;
+
+  /**
+   * @brief Вершины сразу после загрузки; сохраняются при первом bake().
+   */
+  std::optional<Vertices> original_;
+
+  /**
+   * @brief См. geometryVersion().
+   */
+  uint64_t geometry_version_ = 0;
+
+  /**
+   * @brief Изменения геометрии с прошлого takeChanges().
+   */
+  Mesh_changes changes_;
+
+  /**
+   * @brief Центр и делитель нормализации по рамке вершин с учётом
+   * transform.
+   * @param center Центр рамки.
+   * @return Делитель, после которого модель помещается в kNormalizationScale.
+   */
+  float normalization_divisor(Vertex &center) const;
+
+  /**
+   * @brief Нормализует сами вершины; используется при загрузке.
+   */
+  void normalize_vertices();
+
   /**
    * @brief Выполняет триангуляцию многоугольников модели.
-   * @param raw_polygons Массив полигонов (списков индексов вершин).
+   * @param raw_polygons Полигоны (списки индексов вершин).
    */
-  void triangulation(std::vector<std::vector<int>> raw_polygons);
+  void triangulation(const Faces &raw_polygons);
 };
 
 }  // namespace s21
\ No newline at end of file
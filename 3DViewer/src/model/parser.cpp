@@ -8,37 +8,199 @@
 
 #include "parser.h"
 
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <thread>
+
+#include "load_preview.h"
+#include "mapped_file.h"
+#include "tokenizer.h"
+
 namespace s21 {
 
 Parser::Parser() = default;
 // Parser::Parser(const std::string &filename) { initParser(filename); }
 
-void Parser::initParser(const std::string filename) {
-  std::setlocale(LC_NUMERIC, "C");
+void Parser::initParser(const std::string filename, unsigned threads,
+                        Load_progress *progress) {
+  progress_ = progress;
   vertices.clear();
   polygons.clear();
   raw_polygons.clear();
   response = Response::BadFile;
-  std::ifstream file(filename);
-  std::string line;
-  if (file.is_open()) {
-    while (std::getline(file, line)) {
-      parsing(line);
+  bool opened = false;
+  // Сжатый файл не отображается: сигнатура проверяется чтением начала
+  std::optional<Mapped_file> mapped;
+  if (file_compression(filename) == Compression::None)
+    mapped.emplace(filename);
+  if (mapped && mapped->is_open()) {
+    if (progress_) progress_->bytes_total = mapped->view().size();
+    parse_parallel(mapped->view(), std::max(threads, 1u));
+    opened = true;
+  } else if (auto input = Input_stream::open(filename)) {
+    if (progress_) progress_->bytes_total = input->source_size();
+    std::vector<Parse_chunk> chunks(1);
+    parse_stream(*input, chunks[0]);
+    if (!input->failed() && !(progress_ && progress_->cancelled))
+      merge(chunks);
+    opened = !input->failed();
+  }
+  bool cancelled = progress_ && progress_->cancelled;
+  if (cancelled || !opened) {
+    vertices.clear();
+    polygons.clear();
+    raw_polygons.clear();
+    if (cancelled) response = Response::Cancelled;
+  } else if (!polygons.empty() || !raw_polygons.empty()) {
+    response = Response::NormalDone;
+  }
+}
+
+void Parser::parse_parallel(std::string_view text, unsigned threads) {
+  size_t count = std::min<size_t>(threads, text.size() / kMinChunkSize + 1);
+  std::vector<std::string_view> parts;
+  size_t begin = 0;
+  for (size_t i = 1; i <= count && begin < text.size(); i++) {
+    size_t end = std::max(text.size() * i / count, begin);
+    if (end < text.size()) {
+      end = text.find('\n', end);
+      end = end == std::string_view::npos ? text.size() : end + 1;
+    }
+    parts.push_back(text.substr(begin, end - begin));
+    begin = end;
+  }
+
+  std::vector<Parse_chunk> chunks(parts.size());
+  if (parts.size() == 1) {
+    parse_text(parts[0], chunks[0], true);
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(parts.size());
+    for (size_t i = 0; i < parts.size(); i++)
+      workers.emplace_back([this, &parts, &chunks, i] {
+        parse_text(parts[i], chunks[i], i == 0);
+      });
+    for (auto &worker : workers) worker.join();
+  }
+  if (progress_ && progress_->cancelled) return;
+  merge(chunks);
+}
+
+void Parser::parse_text(std::string_view text, Parse_chunk &chunk,
+                        bool preview) {
+  const char *reported = text.data();
+  size_t faces = 0, shown_vertices = 0, shown_faces = 0;
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    parsing(text.substr(0, end), chunk);
+    if (end == std::string_view::npos) break;
+    text.remove_prefix(end + 1);
+    if (progress_ && size_t(text.data() - reported) >= kProgressStep) {
+      size_t parsed = chunk.raw_polygons.size();
+      if (preview) publish(chunk, shown_vertices, shown_faces);
+      if (!report(text.data() - reported, parsed - faces)) return;
+      reported = text.data();
+      faces = parsed;
+    }
+  }
+  if (preview) publish(chunk, shown_vertices, shown_faces);
+  report(text.data() + text.size() - reported,
+         chunk.raw_polygons.size() - faces);
+}
+
+void Parser::parse_stream(Input_stream &input, Parse_chunk &chunk) {
+  std::vector<char> buffer(Input_stream::kBlockSize);
+  size_t kept = 0, faces = 0, shown_vertices = 0, shown_faces = 0;
+  uint64_t consumed = 0;
+  for (;;) {
+    if (kept == buffer.size()) buffer.resize(buffer.size() * 2);
+    size_t got = input.read(buffer.data() + kept, buffer.size() - kept);
+    std::string_view text(buffer.data(), kept + got);
+    size_t end = text.size();
+    if (got > 0) {
+      size_t last = text.rfind('\n');
+      end = last == std::string_view::npos ? 0 : last + 1;
+    }
+    parse_lines(text.substr(0, end), chunk);
+    kept = text.size() - end;
+    std::memmove(buffer.data(), buffer.data() + end, kept);
+
+    size_t parsed = chunk.raw_polygons.size();
+    publish(chunk, shown_vertices, shown_faces);
+    bool proceed = report(input.consumed() - consumed, parsed - faces);
+    consumed = input.consumed();
+    faces = parsed;
+    if (got == 0 || !proceed) break;
+  }
+}
+
+void Parser::parse_lines(std::string_view text, Parse_chunk &chunk) {
+  while (!text.empty()) {
+    size_t end = text.find('\n');
+    parsing(text.substr(0, end), chunk);
+    if (end == std::string_view::npos) break;
+    text.remove_prefix(end + 1);
+  }
+}
+
+void Parser::publish(const Parse_chunk &chunk, size_t &vertices,
+                     size_t &faces) {
+  if (!progress_ || !progress_->preview) return;
+  progress_->preview->append(
+      std::span<const Vertex>(chunk.vertices).subspan(vertices),
+      chunk.raw_polygons, faces);
+  vertices = chunk.vertices.size();
+  faces = chunk.raw_polygons.size();
+}
+
+bool Parser::report(size_t bytes, size_t faces) {
+  if (!progress_) return true;
+  progress_->bytes_read.fetch_add(bytes, std::memory_order_relaxed);
+  progress_->faces_parsed.fetch_add(faces, std::memory_order_relaxed);
+  return !progress_->cancelled.load(std::memory_order_relaxed);
+}
+
+void Parser::merge(std::vector<Parse_chunk> &chunks) {
+  check_validation(chunks);
+  if (chunks.size() == 1) {
+    vertices = std::move(chunks[0].vertices);
+  } else {
+    size_t vertex_count = 0;
+    for (const auto &chunk : chunks) vertex_count += chunk.vertices.size();
+    vertices.reserve(vertex_count);
+    for (auto &chunk : chunks) {
+      vertices.insert(vertices.end(), chunk.vertices.begin(),
+                      chunk.vertices.end());
+      chunk.vertices = Vertices();  // освобождаем память участка сразу
     }
-    if (vertices.size() >= 3 && !raw_polygons.empty()) check_validation();
-    if (!polygons.empty() || !raw_polygons.empty())
-      response = Response::NormalDone;
   }
-  std::setlocale(LC_NUMERIC, "");
+  chunks.clear();
 }
 
-void Parse_vertex::parse_vertex(std::string line, Vertices *vertices) {
-  std::istringstream iss(line.substr(1));  // Пропускаем 'v'
+void Parse_chunk::resolve_last() {
+  int count = vertices.size();
+  for (size_t pos = raw_polygons.offsets[raw_polygons.size() - 1];
+       pos < raw_polygons.indices.size(); pos++) {
+    int &idx = raw_polygons.indices[pos];
+    if (idx < 0) {
+      idx += count;
+      relative.push_back(pos);
+    } else {
+      idx -= 1;
+    }
+  }
+}
+
+void Parse_vertex::parse_vertex(std::string_view line, Vertices *vertices) {
+  Tokenizer tokenizer(line.substr(1));  // Пропускаем 'v'
   float x = 0, y = 0, z = 0;
 
-  if (iss >> x >> y >> z) {
-    Vertex temp_vertex{x, y, z};
-    vertices->push_back(temp_vertex);
+  if (tokenizer.next_float(x) && tokenizer.next_float(y) &&
+      tokenizer.next_float(z)) {
+    vertices->push_back({x, y, z});
   } else {
 #ifdef DEBUG
     std::cerr << "Невозможно прочитать вершину из строки: " << line << "\n";
@@ -46,35 +208,25 @@ void Parse_vertex::parse_vertex(std::string line, Vertices *vertices) {
   }
 }
 
-void Parse_poligon::parse_poligon(std::string line,
-                                  std::vector<std::vector<int>> *raw_polygons) {
-  std::vector<int> temp_polygon;
-  std::istringstream iss(line);
-  std::string token;
-  iss >> token;  // пропускаем "f"
-  while (iss >> token) {
-    size_t slash_pos = token.find('/');
-    std::string vertex_index_str;
-    if (slash_pos != std::string::npos) {
-      // Есть слэш — берем всё до него
-      vertex_index_str = token.substr(0, slash_pos);
+void Parse_poligon::parse_poligon(std::string_view line, Faces *raw_polygons) {
+  Tokenizer tokenizer(line);
+  std::string_view token;
+  tokenizer.next_token(token);  // пропускаем "f"
+  while (tokenizer.next_token(token)) {
+    // Индекс вершины — всё до первого слэша: v, v/vt, v//vn, v/vt/vn
+    int vertex_index = 0;
+    if (Tokenizer::parse_index(token, vertex_index)) {
+      raw_polygons->indices.push_back(vertex_index);
     } else {
-      // Нет слэша — берем всё слово
-      vertex_index_str = token;
-    }
-    // Преобразуем в число
-    try {
-      int vertex_index = std::stoi(vertex_index_str);
-      temp_polygon.push_back(vertex_index);
-    } catch (const std::exception &e) {
 #ifdef DEBUG
       std::cerr << "Невозможно разобрать индекс вершины из '" << token << "'\n";
 #endif
     }
   }
-  if (temp_polygon.size() >= 3) {
-    raw_polygons->push_back(temp_polygon);
+  if (raw_polygons->open_size() >= 3) {
+    raw_polygons->close_face();
   } else {
+    raw_polygons->discard_face();
 #ifdef DEBUG
     std::cerr << "Предупреждение: полигон содержит менее 3 вершин — "
                  "проигнорирован.\n";
@@ -82,36 +234,63 @@ void Parse_poligon::parse_poligon(std::string line,
   }
 }
 
-void Parser::check_validation() {
-  int countVertex = vertices.size();
-  polygons.reserve(raw_polygons.size());
-  for (int i = raw_polygons.size() - 1; i >= 0; i--) {
-    std::vector<int> &temp = raw_polygons[i];
-    for (int j = temp.size() - 1; j >= 0; j--) {
-      int idx = temp[j];
-      if (idx < 0)
-        idx = countVertex + idx;
-      else
-        idx = idx - 1;
-      if (idx >= countVertex || idx < 0)
-        temp.erase(temp.begin() + j);
-      else
-        temp[j] = idx;
+void Parser::check_validation(std::vector<Parse_chunk> &chunks) {
+  size_t vertex_count = 0, face_count = 0, index_count = 0;
+  for (const auto &chunk : chunks) {
+    vertex_count += chunk.vertices.size();
+    face_count += chunk.raw_polygons.size();
+    index_count += chunk.raw_polygons.indices.size();
+  }
+  const int countVertex = vertex_count;
+  // Единственный участок уплотняется на месте: запись не обгоняет чтение.
+  if (chunks.size() == 1) {
+    raw_polygons = std::move(chunks[0].raw_polygons);
+  } else {
+    raw_polygons.indices.resize(index_count);
+    raw_polygons.offsets.resize(face_count + 1);
+  }
+  polygons.reserve(face_count);
+
+  int *out = raw_polygons.indices.data();
+  size_t write = 0, kept = 0;
+  int base = 0;
+  for (auto &chunk : chunks) {
+    Faces &faces = chunks.size() == 1 ? raw_polygons : chunk.raw_polygons;
+    for (size_t pos : chunk.relative) faces.indices[pos] += base;
+    base += chunk.vertices.size();
+    size_t begin = 0;
+    for (size_t f = 0; f < faces.size(); f++) {
+      size_t end = faces.offsets[f + 1];
+      size_t start = write;
+      for (size_t r = begin; r < end; r++) {
+        int idx = faces.indices[r];
+        if (idx >= 0 && idx < countVertex) out[write++] = idx;
+      }
+      begin = end;
+      if (write - start == 3) {
+        polygons.push_back({out[start], out[start + 1], out[start + 2]});
+        write = start;
+      } else if (write - start > 3) {
+        raw_polygons.offsets[++kept] = write;
+      } else {
+        write = start;
+      }
     }
-    if (temp.size() == 3) {
-      polygons.push_back({temp[0], temp[1], temp[2]});
-      raw_polygons.erase(raw_polygons.begin() + i);
-    } else if (temp.size() < 3)
-      raw_polygons.erase(raw_polygons.begin() + i);
+    if (chunks.size() > 1) chunk.raw_polygons = Faces();
   }
+  raw_polygons.indices.resize(write);
+  raw_polygons.offsets.resize(kept + 1);
 }
 
-void Parser::parsing(std::string line) {
-  if (line.empty() || line[0] == '#') return;
-  if ((line[0] == 'v' || line[0] == 'V') && isspace(line[1])) {
-    parse_vertex.parse_vertex(line, &vertices);
-  } else if ((line[0] == 'f' || line[0] == 'F') && isspace(line[1])) {
-    parse_poligon.parse_poligon(line, &raw_polygons);
+void Parser::parsing(std::string_view line, Parse_chunk &chunk) {
+  if (line.size() < 2 || line[0] == '#') return;
+  bool separated = std::isspace(static_cast<unsigned char>(line[1]));
+  if ((line[0] == 'v' || line[0] == 'V') && separated) {
+    parse_vertex.parse_vertex(line, &chunk.vertices);
+  } else if ((line[0] == 'f' || line[0] == 'F') && separated) {
+    size_t count = chunk.raw_polygons.size();
+    parse_poligon.parse_poligon(line, &chunk.raw_polygons);
+    if (chunk.raw_polygons.size() != count) chunk.resolve_last();
   }
 }
 }  // namespace s21
@@ -11,13 +11,12 @@
 
 #pragma once
 
-#include <cstdio>
 #include <fstream>
-#include <locale>
-#include <sstream>
+#include <string_view>
 #include <vector>
 
 #include "common.h"
+#include "input_stream.h"
 
 namespace s21 {
 /**
@@ -36,7 +35,7 @@ class Parse_vertex {
    *
    * Формат строки: "v x y z"
    */
-  void parse_vertex(std::string line, Vertices *vertices);
+  void parse_vertex(std::string_view line, Vertices *vertices);
 };
 
 /**
@@ -54,11 +53,42 @@ class Parse_poligon {
    * @param line Строка, начинающаяся с 'f' и содержащая индексы вершин.
    * @param raw_polygons Указатель на контейнер для добавления результата.
    *
-   * Поддерживает как строки формата "f 1 2 3", так и "f 1/1 2/2 3/3".
+   * Поддерживает строки форматов "f 1 2 3", "f 1/1 2/2 3/3", "f 1//1 2//2
+   * 3//3" и "f 1/1/1 2/2/2 3/3/3". Некорректные индексы пропускаются.
    * Игнорирует полигоны с менее чем 3 вершинами.
    */
-  void parse_poligon(std::string line,
-                     std::vector<std::vector<int>> *raw_polygons);
+  void parse_poligon(std::string_view line, Faces *raw_polygons);
+};
+
+/**
+ * @struct Parse_chunk
+ * @brief Результат разбора непрерывного участка .obj-файла.
+ *
+ * Индексы полигонов хранятся уже с нуля. Отрицательные (относительные)
+ * индексы разрешаются по числу вершин, прочитанных в этом участке к моменту
+ * появления грани; их позиции сохраняются в `relative`, чтобы при слиянии
+ * участков добавить к ним число вершин всех предыдущих участков.
+ */
+struct Parse_chunk {
+  /**
+   * @brief Вершины участка.
+   */
+  Vertices vertices;
+
+  /**
+   * @brief Полигоны участка.
+   */
+  Faces raw_polygons;
+
+  /**
+   * @brief Позиции в `raw_polygons.indices` индексов, заданных относительно.
+   */
+  std::vector<size_t> relative;
+
+  /**
+   * @brief Переводит индексы последнего добавленного полигона в отсчёт с нуля.
+   */
+  void resolve_last();
 };
 
 /**
@@ -93,23 +123,111 @@ class Parser {
   /**
    * @brief Исходные полигоны (ещё не разбиты на треугольники).
    */
-  std::vector<std::vector<int>> raw_polygons;  // до триангуляции
+  Faces raw_polygons;  // до триангуляции
 
   /**
    * @brief Выполняет полную инициализацию парсера и загрузку данных.
    * @param filename Имя файла.
+   * @param threads Число потоков разбора (0 и 1 — последовательный разбор).
+   * @param progress Счётчики прогресса и флаг отмены (может быть nullptr).
+   *
+   * Обычный файл отображается в память и читается без копирования строк.
+   * Если отображение невозможно (канал, пустой или специальный файл) или
+   * файл сжат (gzip, zstd), он читается потоком через Input_stream блоками
+   * фиксированного размера. Имя `-` означает стандартный ввод.
+   *
+   * При `threads > 1` отображённый файл делится по границам строк на участки,
+   * которые разбираются параллельно и затем сливаются. Результат совпадает
+   * с последовательным разбором.
+   *
+   * Если загрузка отменена через `progress`, результат очищается, а
+   * `response` становится Response::Cancelled.
+   *
+   * Если задан `progress->preview`, начало файла выкладывается в него
+   * порциями по мере разбора. При параллельном разборе это первый участок:
+   * индексы остальных становятся известны только после слияния.
    */
-  void initParser(const std::string filename);
+  void initParser(const std::string filename, unsigned threads = 1,
+                  Load_progress *progress = nullptr);
 
  private:
+  /**
+   * @brief Минимальный размер участка для параллельного разбора (байт).
+   */
+  static constexpr size_t kMinChunkSize = 1 << 20;
+
+  /**
+   * @brief Через сколько байт обновляется прогресс и проверяется отмена.
+   */
+  static constexpr size_t kProgressStep = 1 << 18;
+
+  /**
+   * @brief Счётчики прогресса текущей загрузки (nullptr — не нужны).
+   */
+  Load_progress *progress_ = nullptr;
+
+  /**
+   * @brief Передаёт в `progress_` порцию прогресса.
+   * @return false, если загрузку нужно прервать.
+   */
+  bool report(size_t bytes, size_t faces);
+
+  /**
+   * @brief Делит текст на участки и разбирает их в нескольких потоках.
+   * @param text Содержимое файла целиком.
+   * @param threads Максимальное число потоков.
+   */
+  void parse_parallel(std::string_view text, unsigned threads);
+
+  /**
+   * @brief Разбирает участок отображённого в память файла.
+   * @param text Участок, начинающийся с начала строки.
+   * @param chunk Куда складывается результат.
+   * @param preview Выкладывать ли разобранное в `progress_->preview`.
+   *
+   * Строки передаются в parsing() как срезы `text`, без выделения памяти.
+   */
+  void parse_text(std::string_view text, Parse_chunk &chunk,
+                  bool preview = false);
+
+  /**
+   * @brief Разбирает поток блоками Input_stream::kBlockSize.
+   * @param input Источник (файл, канал, распаковщик).
+   * @param chunk Куда складывается результат.
+   *
+   * Незаконченная строка в конце блока переносится в начало следующего,
+   * поэтому память ограничена размером блока (или самой длинной строки).
+   */
+  void parse_stream(Input_stream &input, Parse_chunk &chunk);
+
+  /**
+   * @brief Разбирает все строки текста подряд.
+   */
+  void parse_lines(std::string_view text, Parse_chunk &chunk);
+
+  /**
+   * @brief Дописывает в `progress_->preview` новую часть участка.
+   * @param chunk Участок, начинающийся с начала файла.
+   * @param vertices Сколько вершин участка уже выложено (обновляется).
+   * @param faces Сколько граней участка уже выложено (обновляется).
+   */
+  void publish(const Parse_chunk &chunk, size_t &vertices, size_t &faces);
+
   /**
    * @brief Выполняет первичную обработку строки.
    * @param line Строка из .obj-файла.
+   * @param chunk Куда складывается результат.
    *
    * Игнорирует пустые и комментарии. В зависимости от типа вызывает
    * соответствующий парсер.
    */
-  void parsing(std::string line);
+  void parsing(std::string_view line, Parse_chunk &chunk);
+
+  /**
+   * @brief Сливает участки в итоговые списки в порядке следования в файле.
+   * @param chunks Результаты разбора участков.
+   */
+  void merge(std::vector<Parse_chunk> &chunks);
 
   /**
    * @brief Объект для разбора вершин.
@@ -122,11 +240,18 @@ class Parser {
   Parse_poligon parse_poligon;
 
   /**
-   * @brief Проверяет валидность и диапазоны индексов в полигонах.
+   * @brief Проверяет индексы полигонов и раскладывает полигоны по спискам.
+   * @param chunks Результаты разбора участков.
+   *
+   * Выполняется за один линейный проход по индексам всех участков: сдвигает
+   * относительные индексы на число вершин предыдущих участков, удаляет
+   * индексы вне диапазона вершин, переносит треугольники в `polygons`, а
+   * полигоны из четырёх и более вершин уплотняет в `raw_polygons`.
    *
-   * Обрабатывает отрицательные индексы, удаляет некорректные и
-   * переносит треугольники в итоговый список.
+   * Проверка не может выполняться при чтении строки: положительный индекс
+   * может ссылаться на вершину, объявленную ниже по файлу, поэтому верхняя
+   * граница известна только в конце.
    */
-  void check_validation();
+  void check_validation(std::vector<Parse_chunk> &chunks);
 };
 }  // namespace s21
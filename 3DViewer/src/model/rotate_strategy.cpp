@@ -10,6 +10,7 @@
 #include "rotate_strategy.h"
 
 #include <cmath>
+#include <stdexcept>
 
 namespace s21 {
 Rotate_strategy::Rotate_strategy(float angle_deg) {
@@ -33,6 +34,73 @@ void RotateZ::rotation(Vertices &vertices) {
   for (auto &v : vertices) rotate2D(v.x, v.y, false);
 }
 
+namespace {
+using Rows = std::array<float, 9>;
+
+/**
+ * @brief Произведение матриц 3×3 `a · b`.
+ */
+Rows multiply(const Rows &a, const Rows &b) {
+  Rows r{};
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      r[i * 3 + j] = a[i * 3] * b[j] + a[i * 3 + 1] * b[3 + j] +
+                     a[i * 3 + 2] * b[6 + j];
+  return r;
+}
+}  // namespace
+
+RotateComposite RotateComposite::euler(Vertex degrees) {
+  const float k = PI / 180.f;
+  float cx = cos(degrees.x * k), sx = sin(degrees.x * k);
+  float cy = cos(degrees.y * k), sy = sin(degrees.y * k);
+  float cz = cos(degrees.z * k), sz = sin(degrees.z * k);
+  Rows rx = {1, 0, 0, 0, cx, -sx, 0, sx, cx};
+  Rows ry = {cy, 0, sy, 0, 1, 0, -sy, 0, cy};
+  Rows rz = {cz, -sz, 0, sz, cz, 0, 0, 0, 1};
+  return RotateComposite(multiply(rz, multiply(ry, rx)));
+}
+
+RotateComposite RotateComposite::axis_angle(Vertex axis, float degrees) {
+  float length =
+      std::sqrt(axis.x * axis.x + axis.y * axis.y + axis.z * axis.z);
+  if (length == 0.0f) throw std::invalid_argument("Нулевая ось вращения");
+  Vertex n = axis / length;
+  float angle = degrees * (PI / 180.f);
+  float c = cos(angle), s = sin(angle), t = 1 - c;
+  return RotateComposite({t * n.x * n.x + c, t * n.x * n.y - s * n.z,
+                          t * n.x * n.z + s * n.y, t * n.x * n.y + s * n.z,
+                          t * n.y * n.y + c, t * n.y * n.z - s * n.x,
+                          t * n.x * n.z - s * n.y, t * n.y * n.z + s * n.x,
+                          t * n.z * n.z + c});
+}
+
+RotateComposite RotateComposite::quaternion(float w, float x, float y,
+                                            float z) {
+  float length = std::sqrt(w * w + x * x + y * y + z * z);
+  if (length == 0.0f) throw std::invalid_argument("Нулевой кватернион");
+  w /= length;
+  x /= length;
+  y /= length;
+  z /= length;
+  return RotateComposite({1 - 2 * (y * y + z * z), 2 * (x * y - w * z),
+                          2 * (x * z + w * y), 2 * (x * y + w * z),
+                          1 - 2 * (x * x + z * z), 2 * (y * z - w * x),
+                          2 * (x * z - w * y), 2 * (y * z + w * x),
+                          1 - 2 * (x * x + y * y)});
+}
+
+Vertex RotateComposite::apply(Vertex v) const {
+  const Rows &r = rows_;
+  return {r[0] * v.x + r[1] * v.y + r[2] * v.z,
+          r[3] * v.x + r[4] * v.y + r[5] * v.z,
+          r[6] * v.x + r[7] * v.y + r[8] * v.z};
+}
+
+void RotateComposite::rotation(Vertices &vertices) {
+  for (auto &v : vertices) v = apply(v);
+}
+
 void Rotate_strategy::rotate2D(float &a, float &b, bool invertSin = false) {
   float sin_ = invertSin ? -sinA : sinA;
   float a_ = a * cosA - b * sin_;
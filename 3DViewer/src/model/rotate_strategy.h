@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <array>
 #include <numbers>
 #include <string>
 #include <vector>
@@ -48,6 +49,11 @@ class Rotate_strategy {
   virtual void rotation(Vertices &vertices) = 0;
 
  protected:
+  /**
+   * @brief Конструктор для стратегий, не связанных с одним углом.
+   */
+  Rotate_strategy() : cosA(1.0f), sinA(0.0f) {}
+
   /**
    * @brief Выполняет вращение пары координат в 2D-плоскости.
    * @param a Первая координата (например, x или y).
@@ -70,6 +76,7 @@ class Rotate_strategy {
    */
   float sinA;
 
+ protected:
   /**
    * @brief Константа числа π (пи).
    */
@@ -111,6 +118,62 @@ class RotateZ : public Rotate_strategy {
  public:
   void rotation(Vertices &vertices) override;
 };
+/**
+ * @class RotateComposite
+ * @brief Стратегия вращения произвольной матрицей поворота 3×3.
+ *
+ * Поворот вокруг нескольких осей сразу (углы Эйлера), вокруг произвольной
+ * оси или заданный кватернионом сводится к одной матрице, поэтому вершины
+ * обходятся один раз, а не по разу на ось.
+ *
+ * Реализация паттерна **Стратегия**.
+ */
+class RotateComposite : public Rotate_strategy {
+ public:
+  /**
+   * @brief Поворот углами Эйлера: сначала вокруг X, затем Y, затем Z.
+   * @param degrees Углы в градусах по осям.
+   *
+   * Совпадает с последовательным применением RotateX, RotateY и RotateZ.
+   */
+  static RotateComposite euler(Vertex degrees);
+
+  /**
+   * @brief Поворот вокруг произвольной оси (формула Родрига).
+   * @param axis Ось вращения, не обязательно единичной длины.
+   * @param degrees Угол в градусах.
+   * @throw std::invalid_argument Если ось нулевая.
+   */
+  static RotateComposite axis_angle(Vertex axis, float degrees);
+
+  /**
+   * @brief Поворот, заданный кватернионом `w + xi + yj + zk`.
+   * @throw std::invalid_argument Если кватернион нулевой.
+   *
+   * Кватернион нормируется, поэтому его длина может быть любой.
+   */
+  static RotateComposite quaternion(float w, float x, float y, float z);
+
+  void rotation(Vertices &vertices) override;
+
+  /**
+   * @brief Поворачивает одну точку.
+   */
+  Vertex apply(Vertex v) const;
+
+  /**
+   * @brief Элементы матрицы по строкам: `rows()[row * 3 + column]`.
+   */
+  const std::array<float, 9> &rows() const { return rows_; }
+
+ private:
+  explicit RotateComposite(const std::array<float, 9> &rows) : rows_(rows) {}
+
+  /**
+   * @brief Матрица поворота по строкам.
+   */
+  std::array<float, 9> rows_;
+};
 /**
  * @class Apply_rotation_strategy
  * @brief Контекст для применения стратегии вращения.
@@ -0,0 +1,69 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Реализация пула потоков.
+ */
+
+#include "thread_pool.h"
+
+namespace s21 {
+
+Thread_pool::Thread_pool(unsigned threads) {
+  for (unsigned i = 1; i < threads; i++)
+    workers_.emplace_back([this] { work(); });
+}
+
+Thread_pool::~Thread_pool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_) worker.join();
+}
+
+void Thread_pool::run(size_t tasks, const std::function<void(size_t)> &task) {
+  if (tasks == 0) return;
+  std::lock_guard run_lock(run_mutex_);
+  {
+    std::lock_guard lock(mutex_);
+    task_ = &task;
+    tasks_ = tasks;
+    finished_ = 0;
+    next_ = 0;
+    generation_++;
+  }
+  wake_.notify_all();
+  size_t done = drain();
+  std::unique_lock lock(mutex_);
+  finished_ += done;
+  // Ждём и опоздавших: рабочий не должен держать task_ после возврата
+  done_.wait(lock, [this] { return finished_ == tasks_ && busy_ == 0; });
+  task_ = nullptr;
+}
+
+void Thread_pool::work() {
+  uint64_t seen = 0;
+  std::unique_lock lock(mutex_);
+  for (;;) {
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+    if (stop_) return;
+    seen = generation_;
+    // Проснулся после окончания run(): задачи уже разобраны
+    if (!task_) continue;
+    busy_++;
+    lock.unlock();
+    size_t done = drain();
+    lock.lock();
+    busy_--;
+    finished_ += done;
+    if (finished_ == tasks_ && busy_ == 0) done_.notify_one();
+  }
+}
+
+size_t Thread_pool::drain() {
+  size_t done = 0;
+  for (size_t i = next_++; i < tasks_; i = next_++, done++) (*task_)(i);
+  return done;
+}
+
+}  // namespace s21
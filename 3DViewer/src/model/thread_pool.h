@@ -0,0 +1,76 @@
+/**
+ * @file thread_pool.h
+ * @brief Постоянный пул потоков для параллельной обработки вершин.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+/**
+ * @class Thread_pool
+ * @brief Пул потоков, выполняющий пронумерованные задачи.
+ *
+ * Потоки создаются один раз и ждут работы, поэтому каждая операция над
+ * моделью не платит за создание потоков. Вызывающий поток тоже берёт
+ * задачи, так что пул из N потоков держит N − 1 рабочих.
+ */
+class Thread_pool {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param threads Общее число потоков, включая вызывающий (не меньше 1).
+   */
+  explicit Thread_pool(unsigned threads);
+  ~Thread_pool();
+
+  Thread_pool(const Thread_pool &) = delete;
+  Thread_pool &operator=(const Thread_pool &) = delete;
+
+  /**
+   * @brief Общее число потоков, включая вызывающий.
+   */
+  unsigned size() const { return workers_.size() + 1; }
+
+  /**
+   * @brief Выполняет `task(0) … task(tasks - 1)` и ждёт завершения всех.
+   *
+   * Задачи разбираются потоками по очереди, порядок выполнения не задан.
+   * Одновременные вызовы из разных потоков выполняются по одному.
+   */
+  void run(size_t tasks, const std::function<void(size_t)> &task);
+
+ private:
+  /**
+   * @brief Цикл рабочего потока.
+   */
+  void work();
+
+  /**
+   * @brief Берёт и выполняет задачи, пока они не кончатся.
+   * @return Число выполненных задач.
+   */
+  size_t drain();
+
+  std::vector<std::thread> workers_;
+  std::mutex run_mutex_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(size_t)> *task_ = nullptr;
+  size_t tasks_ = 0;
+  std::atomic<size_t> next_{0};
+  size_t finished_ = 0;
+  unsigned busy_ = 0;
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+};
+}  // namespace s21
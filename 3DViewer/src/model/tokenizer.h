@@ -0,0 +1,124 @@
+/**
+ * @file tokenizer.h
+ * @brief Разбор числовых полей строк .obj-файла без потоков и исключений.
+ *
+ * Построен на `std::from_chars`, поэтому не зависит от глобальной локали
+ * процесса и не выделяет память: все токены — срезы исходной строки.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <limits>
+#include <string_view>
+
+namespace s21 {
+/**
+ * @class Tokenizer
+ * @brief Последовательно извлекает токены и числа из строки.
+ *
+ * Повторяет правила `std::istream >> float` и `std::stoi`, которыми
+ * раньше пользовался парсер: допускается знак `+`, разбор числа
+ * останавливается на первом неподходящем символе, ошибка не бросает
+ * исключение, а возвращает `false`.
+ */
+class Tokenizer {
+ public:
+  /**
+   * @brief Конструктор.
+   * @param text Разбираемая строка (не копируется).
+   */
+  explicit Tokenizer(std::string_view text) : text_(text) {}
+
+  /**
+   * @brief Читает следующее вещественное число.
+   * @param value Куда записывается результат.
+   * @return false, если число прочитать не удалось.
+   */
+  bool next_float(float &value) {
+    skip_space();
+    std::string_view rest = text_;
+    bool negative = strip_sign(rest);
+    if (!starts_number(rest)) return false;
+    auto [ptr, ec] =
+        std::from_chars(rest.data(), rest.data() + rest.size(), value);
+    if (ec != std::errc()) return false;
+    if (negative) value = -value;
+    text_.remove_prefix(ptr - text_.data());
+    return true;
+  }
+
+  /**
+   * @brief Читает следующий токен, ограниченный пробельными символами.
+   * @param token Куда записывается срез строки.
+   * @return false, если строка закончилась.
+   */
+  bool next_token(std::string_view &token) {
+    skip_space();
+    if (text_.empty()) return false;
+    size_t end = 0;
+    while (end < text_.size() && !is_space(text_[end])) end++;
+    token = text_.substr(0, end);
+    text_.remove_prefix(end);
+    return true;
+  }
+
+  /**
+   * @brief Разбирает индекс вершины из токена грани.
+   * @param token Токен вида `v`, `v/vt`, `v//vn` или `v/vt/vn`.
+   * @param value Куда записывается индекс в исходной (с единицы) нумерации.
+   * @return false, если перед первым `/` нет целого числа.
+   */
+  static bool parse_index(std::string_view token, int &value) {
+    token = token.substr(0, token.find('/'));
+    bool negative = strip_sign(token);
+    if (token.empty() || !is_digit(token[0])) return false;
+    long long parsed = 0;
+    auto [ptr, ec] =
+        std::from_chars(token.data(), token.data() + token.size(), parsed);
+    if (ec != std::errc()) return false;
+    if (negative) parsed = -parsed;
+    if (parsed < std::numeric_limits<int>::min() ||
+        parsed > std::numeric_limits<int>::max())
+      return false;
+    value = static_cast<int>(parsed);
+    return true;
+  }
+
+ private:
+  static bool is_space(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  }
+  static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  /**
+   * @brief Отбрасывает знак числа.
+   * @return true, если знак был `-`.
+   */
+  static bool strip_sign(std::string_view &text) {
+    bool negative = !text.empty() && text[0] == '-';
+    if (negative || (!text.empty() && text[0] == '+')) text.remove_prefix(1);
+    return negative;
+  }
+
+  /**
+   * @brief Начинается ли строка с цифр десятичного числа (`1`, `.5`).
+   */
+  static bool starts_number(std::string_view text) {
+    return !text.empty() &&
+           (is_digit(text[0]) ||
+            (text[0] == '.' && text.size() > 1 && is_digit(text[1])));
+  }
+
+  void skip_space() {
+    size_t pos = 0;
+    while (pos < text_.size() && is_space(text_[pos])) pos++;
+    text_.remove_prefix(pos);
+  }
+
+  /**
+   * @brief Ещё не разобранная часть строки.
+   */
+  std::string_view text_;
+};
+}  // namespace s21
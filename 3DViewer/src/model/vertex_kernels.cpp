@@ -0,0 +1,536 @@
+/**
+ * @file vertex_kernels.cpp
+ * @brief Реализация векторизованных операций над вершинами.
+ *
+ * Массив Vertex рассматривается как поток чисел `x y z x y z ...`. Сдвиг,
+ * масштаб, нормализация и рамка — поэлементные операции над этим потоком
+ * с константой периода 3 (шаблон `cx cy cz cx ...`), поэтому они
+ * векторизуются без перестановок: блок из 3 регистров покрывает целое
+ * число вершин (4 для SSE2, 8 для AVX2). Для Vertex_soa тот же код
+ * работает с константой периода 1.
+ *
+ * Аффинное преобразование смешивает координаты, поэтому в массиве Vertex
+ * оно считается по одной (SSE2) или по две (AVX2) вершины на регистр.
+ */
+
+#include "vertex_kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define S21_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace s21 {
+
+namespace {
+
+static_assert(sizeof(Vertex) == 3 * sizeof(float));
+
+using Simd = Vertex_kernels::Simd;
+
+/**
+ * @brief Длина шаблона константы: блок AVX2 из трёх регистров.
+ */
+constexpr size_t kPattern = 24;
+
+constexpr float kMaxFloat = std::numeric_limits<float>::max();
+constexpr float kLowestFloat = std::numeric_limits<float>::lowest();
+
+// Те же правила, что у _mm_min_ps/_mm_max_ps: при равенстве берётся `b`.
+inline float min_of(float a, float b) { return a < b ? a : b; }
+inline float max_of(float a, float b) { return a > b ? a : b; }
+
+/**
+ * @brief Таблица реализаций для одного уровня инструкций.
+ *
+ * Потоковые операции принимают шаблон из kPattern чисел; позиция `j`
+ * от начала массива использует `pattern[j % 3]` (шаблон периодичен).
+ */
+struct Kernels {
+  void (*add)(float *data, size_t count, const float *pattern);
+  void (*mul)(float *data, size_t count, float factor);
+  void (*sub_div)(float *data, size_t count, const float *pattern,
+                  float divisor);
+  void (*min_max)(const float *data, size_t count, float *lo, float *hi);
+  void (*transform)(Vertex *vertices, size_t count, const Matrix4 &matrix);
+  void (*transform_soa)(float *x, float *y, float *z, size_t count,
+                        const Matrix4 &matrix);
+};
+
+// ---------------------------------------------------------------- скаляр
+
+void add_scalar(float *data, size_t count, const float *pattern) {
+  for (size_t j = 0; j < count; j++) data[j] = data[j] + pattern[j % 3];
+}
+
+void mul_scalar(float *data, size_t count, float factor) {
+  for (size_t j = 0; j < count; j++) data[j] = data[j] * factor;
+}
+
+void sub_div_scalar(float *data, size_t count, const float *pattern,
+                    float divisor) {
+  for (size_t j = 0; j < count; j++)
+    data[j] = (data[j] - pattern[j % 3]) / divisor;
+}
+
+void min_max_scalar(const float *data, size_t count, float *lo, float *hi) {
+  for (size_t j = 0; j < count; j++) {
+    lo[j % 3] = min_of(lo[j % 3], data[j]);
+    hi[j % 3] = max_of(hi[j % 3], data[j]);
+  }
+}
+
+void transform_scalar(Vertex *vertices, size_t count, const Matrix4 &matrix) {
+  for (size_t i = 0; i < count; i++) vertices[i] = matrix.apply(vertices[i]);
+}
+
+void transform_soa_scalar(float *x, float *y, float *z, size_t count,
+                          const Matrix4 &matrix) {
+  for (size_t i = 0; i < count; i++) {
+    Vertex v = matrix.apply({x[i], y[i], z[i]});
+    x[i] = v.x;
+    y[i] = v.y;
+    z[i] = v.z;
+  }
+}
+
+constexpr Kernels kScalar = {add_scalar,     mul_scalar,
+                             sub_div_scalar, min_max_scalar,
+                             transform_scalar, transform_soa_scalar};
+
+#ifdef S21_X86_KERNELS
+
+// ------------------------------------------------------------------ SSE2
+
+__attribute__((target("sse2"))) void add_sse2(float *data, size_t count,
+                                              const float *pattern) {
+  const __m128 p0 = _mm_loadu_ps(pattern), p1 = _mm_loadu_ps(pattern + 4),
+               p2 = _mm_loadu_ps(pattern + 8);
+  size_t j = 0;
+  for (; j + 12 <= count; j += 12) {
+    _mm_storeu_ps(data + j, _mm_add_ps(_mm_loadu_ps(data + j), p0));
+    _mm_storeu_ps(data + j + 4, _mm_add_ps(_mm_loadu_ps(data + j + 4), p1));
+    _mm_storeu_ps(data + j + 8, _mm_add_ps(_mm_loadu_ps(data + j + 8), p2));
+  }
+  add_scalar(data + j, count - j, pattern);
+}
+
+__attribute__((target("sse2"))) void mul_sse2(float *data, size_t count,
+                                              float factor) {
+  const __m128 f = _mm_set1_ps(factor);
+  size_t j = 0;
+  for (; j + 4 <= count; j += 4)
+    _mm_storeu_ps(data + j, _mm_mul_ps(_mm_loadu_ps(data + j), f));
+  mul_scalar(data + j, count - j, factor);
+}
+
+__attribute__((target("sse2"))) void sub_div_sse2(float *data, size_t count,
+                                                  const float *pattern,
+                                                  float divisor) {
+  const __m128 p[3] = {_mm_loadu_ps(pattern), _mm_loadu_ps(pattern + 4),
+                       _mm_loadu_ps(pattern + 8)};
+  const __m128 d = _mm_set1_ps(divisor);
+  size_t j = 0;
+  for (; j + 12 <= count; j += 12)
+    for (int k = 0; k < 3; k++) {
+      float *at = data + j + 4 * k;
+      _mm_storeu_ps(at, _mm_div_ps(_mm_sub_ps(_mm_loadu_ps(at), p[k]), d));
+    }
+  sub_div_scalar(data + j, count - j, pattern, divisor);
+}
+
+__attribute__((target("sse2"))) void min_max_sse2(const float *data,
+                                                  size_t count, float *lo,
+                                                  float *hi) {
+  __m128 l[3], h[3];
+  for (int k = 0; k < 3; k++) {
+    l[k] = _mm_loadu_ps(lo + 4 * k);
+    h[k] = _mm_loadu_ps(hi + 4 * k);
+  }
+  size_t j = 0;
+  for (; j + 12 <= count; j += 12)
+    for (int k = 0; k < 3; k++) {
+      __m128 a = _mm_loadu_ps(data + j + 4 * k);
+      l[k] = _mm_min_ps(l[k], a);
+      h[k] = _mm_max_ps(h[k], a);
+    }
+  for (int k = 0; k < 3; k++) {
+    _mm_storeu_ps(lo + 4 * k, l[k]);
+    _mm_storeu_ps(hi + 4 * k, h[k]);
+  }
+  min_max_scalar(data + j, count - j, lo, hi);
+}
+
+/**
+ * @brief Одна вершина на регистр: читаются 4 числа (x, y, z и x следующей
+ * вершины), четвёртое записывается обратно без изменений.
+ */
+__attribute__((target("sse2"))) void transform_sse2(Vertex *vertices,
+                                                    size_t count,
+                                                    const Matrix4 &matrix) {
+  if (count == 0) return;
+  const float *m = matrix.m.data();
+  const __m128 c0 = _mm_loadu_ps(m), c1 = _mm_loadu_ps(m + 4),
+               c2 = _mm_loadu_ps(m + 8), c3 = _mm_loadu_ps(m + 12);
+  const __m128 keep = _mm_castsi128_ps(_mm_set_epi32(-1, 0, 0, 0));
+  float *p = reinterpret_cast<float *>(vertices);
+  for (size_t i = 0; i + 1 < count; i++, p += 3) {
+    __m128 a = _mm_loadu_ps(p);
+    __m128 x = _mm_shuffle_ps(a, a, 0x00), y = _mm_shuffle_ps(a, a, 0x55),
+           z = _mm_shuffle_ps(a, a, 0xAA);
+    __m128 r = _mm_add_ps(
+        _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, x), _mm_mul_ps(c1, y)),
+                   _mm_mul_ps(c2, z)),
+        c3);
+    _mm_storeu_ps(p, _mm_or_ps(_mm_andnot_ps(keep, r), _mm_and_ps(keep, a)));
+  }
+  vertices[count - 1] = matrix.apply(vertices[count - 1]);
+}
+
+__attribute__((target("sse2"))) void transform_soa_sse2(
+    float *x, float *y, float *z, size_t count, const Matrix4 &matrix) {
+  const float *m = matrix.m.data();
+  __m128 c[16];
+  for (int k = 0; k < 16; k++) c[k] = _mm_set1_ps(m[k]);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 vx = _mm_loadu_ps(x + i), vy = _mm_loadu_ps(y + i),
+           vz = _mm_loadu_ps(z + i);
+    float *out[3] = {x + i, y + i, z + i};
+    for (int row = 0; row < 3; row++) {
+      __m128 r = _mm_add_ps(
+          _mm_add_ps(_mm_add_ps(_mm_mul_ps(c[row], vx),
+                                _mm_mul_ps(c[4 + row], vy)),
+                     _mm_mul_ps(c[8 + row], vz)),
+          c[12 + row]);
+      _mm_storeu_ps(out[row], r);
+    }
+  }
+  transform_soa_scalar(x + i, y + i, z + i, count - i, matrix);
+}
+
+constexpr Kernels kSse2 = {add_sse2,     mul_sse2,       sub_div_sse2,
+                           min_max_sse2, transform_sse2, transform_soa_sse2};
+
+// ------------------------------------------------------------------ AVX2
+
+__attribute__((target("avx2"))) void add_avx2(float *data, size_t count,
+                                              const float *pattern) {
+  const __m256 p[3] = {_mm256_loadu_ps(pattern), _mm256_loadu_ps(pattern + 8),
+                       _mm256_loadu_ps(pattern + 16)};
+  size_t j = 0;
+  for (; j + 24 <= count; j += 24)
+    for (int k = 0; k < 3; k++) {
+      float *at = data + j + 8 * k;
+      _mm256_storeu_ps(at, _mm256_add_ps(_mm256_loadu_ps(at), p[k]));
+    }
+  add_scalar(data + j, count - j, pattern);
+}
+
+__attribute__((target("avx2"))) void mul_avx2(float *data, size_t count,
+                                              float factor) {
+  const __m256 f = _mm256_set1_ps(factor);
+  size_t j = 0;
+  for (; j + 8 <= count; j += 8)
+    _mm256_storeu_ps(data + j, _mm256_mul_ps(_mm256_loadu_ps(data + j), f));
+  mul_scalar(data + j, count - j, factor);
+}
+
+__attribute__((target("avx2"))) void sub_div_avx2(float *data, size_t count,
+                                                  const float *pattern,
+                                                  float divisor) {
+  const __m256 p[3] = {_mm256_loadu_ps(pattern), _mm256_loadu_ps(pattern + 8),
+                       _mm256_loadu_ps(pattern + 16)};
+  const __m256 d = _mm256_set1_ps(divisor);
+  size_t j = 0;
+  for (; j + 24 <= count; j += 24)
+    for (int k = 0; k < 3; k++) {
+      float *at = data + j + 8 * k;
+      _mm256_storeu_ps(
+          at, _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(at), p[k]), d));
+    }
+  sub_div_scalar(data + j, count - j, pattern, divisor);
+}
+
+__attribute__((target("avx2"))) void min_max_avx2(const float *data,
+                                                  size_t count, float *lo,
+                                                  float *hi) {
+  __m256 l[3], h[3];
+  for (int k = 0; k < 3; k++) {
+    l[k] = _mm256_loadu_ps(lo + 8 * k);
+    h[k] = _mm256_loadu_ps(hi + 8 * k);
+  }
+  size_t j = 0;
+  for (; j + 24 <= count; j += 24)
+    for (int k = 0; k < 3; k++) {
+      __m256 a = _mm256_loadu_ps(data + j + 8 * k);
+      l[k] = _mm256_min_ps(l[k], a);
+      h[k] = _mm256_max_ps(h[k], a);
+    }
+  for (int k = 0; k < 3; k++) {
+    _mm256_storeu_ps(lo + 8 * k, l[k]);
+    _mm256_storeu_ps(hi + 8 * k, h[k]);
+  }
+  min_max_scalar(data + j, count - j, lo, hi);
+}
+
+/**
+ * @brief Четыре числа в обеих половинах регистра.
+ */
+__attribute__((target("avx2"))) inline __m256 duplicate(const float *at) {
+  __m128 half = _mm_loadu_ps(at);
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(half), half, 1);
+}
+
+/**
+ * @brief Две вершины на регистр: половины читаются с шагом в одну вершину,
+ * младшая записывается раньше старшей.
+ */
+__attribute__((target("avx2"))) void transform_avx2(Vertex *vertices,
+                                                    size_t count,
+                                                    const Matrix4 &matrix) {
+  const float *m = matrix.m.data();
+  const __m256 c0 = duplicate(m), c1 = duplicate(m + 4),
+               c2 = duplicate(m + 8), c3 = duplicate(m + 12);
+  const __m256 keep =
+      _mm256_castsi256_ps(_mm256_set_epi32(-1, 0, 0, 0, -1, 0, 0, 0));
+  float *p = reinterpret_cast<float *>(vertices);
+  size_t i = 0;
+  for (; i + 3 <= count; i += 2, p += 6) {
+    __m256 a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)),
+                                    _mm_loadu_ps(p + 3), 1);
+    __m256 x = _mm256_permute_ps(a, 0x00), y = _mm256_permute_ps(a, 0x55),
+           z = _mm256_permute_ps(a, 0xAA);
+    __m256 r = _mm256_add_ps(
+        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c0, x), _mm256_mul_ps(c1, y)),
+                      _mm256_mul_ps(c2, z)),
+        c3);
+    r = _mm256_or_ps(_mm256_andnot_ps(keep, r), _mm256_and_ps(keep, a));
+    _mm_storeu_ps(p, _mm256_castps256_ps128(r));
+    _mm_storeu_ps(p + 3, _mm256_extractf128_ps(r, 1));
+  }
+  transform_scalar(vertices + i, count - i, matrix);
+}
+
+__attribute__((target("avx2"))) void transform_soa_avx2(
+    float *x, float *y, float *z, size_t count, const Matrix4 &matrix) {
+  const float *m = matrix.m.data();
+  __m256 c[16];
+  for (int k = 0; k < 16; k++) c[k] = _mm256_set1_ps(m[k]);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 vx = _mm256_loadu_ps(x + i), vy = _mm256_loadu_ps(y + i),
+           vz = _mm256_loadu_ps(z + i);
+    float *out[3] = {x + i, y + i, z + i};
+    for (int row = 0; row < 3; row++) {
+      __m256 r = _mm256_add_ps(
+          _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c[row], vx),
+                                      _mm256_mul_ps(c[4 + row], vy)),
+                        _mm256_mul_ps(c[8 + row], vz)),
+          c[12 + row]);
+      _mm256_storeu_ps(out[row], r);
+    }
+  }
+  transform_soa_scalar(x + i, y + i, z + i, count - i, matrix);
+}
+
+constexpr Kernels kAvx2 = {add_avx2,     mul_avx2,       sub_div_avx2,
+                           min_max_avx2, transform_avx2, transform_soa_avx2};
+
+#endif  // S21_X86_KERNELS
+
+Simd detect() {
+#ifdef S21_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) return Simd::Avx2;
+  if (__builtin_cpu_supports("sse2")) return Simd::Sse2;
+#endif
+  return Simd::Scalar;
+}
+
+const Simd kSupported = detect();
+std::atomic<Simd> current{kSupported};
+
+const Kernels &kernels() {
+#ifdef S21_X86_KERNELS
+  switch (current.load(std::memory_order_relaxed)) {
+    case Simd::Avx2:
+      return kAvx2;
+    case Simd::Sse2:
+      return kSse2;
+    default:
+      break;
+  }
+#endif
+  return kScalar;
+}
+
+/**
+ * @brief Шаблон константы `c.x c.y c.z c.x ...` длиной kPattern.
+ */
+std::array<float, kPattern> pattern_of(Vertex c) {
+  std::array<float, kPattern> pattern;
+  for (size_t j = 0; j < kPattern; j += 3) {
+    pattern[j] = c.x;
+    pattern[j + 1] = c.y;
+    pattern[j + 2] = c.z;
+  }
+  return pattern;
+}
+
+std::array<float, kPattern> pattern_of(float value) {
+  std::array<float, kPattern> pattern;
+  pattern.fill(value);
+  return pattern;
+}
+
+float *floats(std::span<Vertex> vertices) {
+  return reinterpret_cast<float *>(vertices.data());
+}
+
+/**
+ * @brief Чистый сдвиг: верхняя часть 3×3 — единичная.
+ */
+bool is_translation(const Matrix4 &matrix) {
+  Matrix4 shifted = matrix;
+  shifted.m[12] = shifted.m[13] = shifted.m[14] = 0;
+  return shifted.is_identity();
+}
+
+/**
+ * @brief Чистый равномерный масштаб: `diag(f, f, f, 1)`.
+ */
+bool is_uniform_scale(const Matrix4 &matrix) {
+  Matrix4 scaled;
+  scaled.scale(matrix.m[0]);
+  return scaled == matrix;
+}
+
+/**
+ * @brief Рамка одного массива координат (для Vertex_soa).
+ */
+void bounds_of(const std::vector<float> &values, float &lo, float &hi) {
+  std::array<float, kPattern> l = pattern_of(kMaxFloat),
+                              h = pattern_of(kLowestFloat);
+  kernels().min_max(values.data(), values.size(), l.data(), h.data());
+  lo = kMaxFloat;
+  hi = kLowestFloat;
+  for (size_t j = 0; j < kPattern; j++) {
+    lo = min_of(lo, l[j]);
+    hi = max_of(hi, h[j]);
+  }
+}
+
+}  // namespace
+
+Vertex_soa Vertex_soa::from(std::span<const Vertex> vertices) {
+  Vertex_soa soa;
+  soa.x.resize(vertices.size());
+  soa.y.resize(vertices.size());
+  soa.z.resize(vertices.size());
+  for (size_t i = 0; i < vertices.size(); i++) {
+    soa.x[i] = vertices[i].x;
+    soa.y[i] = vertices[i].y;
+    soa.z[i] = vertices[i].z;
+  }
+  return soa;
+}
+
+Vertices Vertex_soa::to_vertices() const {
+  Vertices vertices(size());
+  for (size_t i = 0; i < size(); i++) vertices[i] = {x[i], y[i], z[i]};
+  return vertices;
+}
+
+Vertex_kernels::Simd Vertex_kernels::supported() { return kSupported; }
+
+Vertex_kernels::Simd Vertex_kernels::simd() {
+  return current.load(std::memory_order_relaxed);
+}
+
+void Vertex_kernels::set_simd(Simd level) {
+  current.store(std::min(level, kSupported), std::memory_order_relaxed);
+}
+
+void Vertex_kernels::bounds(std::span<const Vertex> vertices, Vertex &min,
+                            Vertex &max) {
+  std::array<float, kPattern> lo = pattern_of(kMaxFloat),
+                              hi = pattern_of(kLowestFloat);
+  kernels().min_max(reinterpret_cast<const float *>(vertices.data()),
+                    vertices.size() * 3, lo.data(), hi.data());
+  min = {kMaxFloat, kMaxFloat, kMaxFloat};
+  max = {kLowestFloat, kLowestFloat, kLowestFloat};
+  float *mn = &min.x, *mx = &max.x;
+  for (size_t j = 0; j < kPattern; j++) {
+    mn[j % 3] = min_of(mn[j % 3], lo[j]);
+    mx[j % 3] = max_of(mx[j % 3], hi[j]);
+  }
+}
+
+void Vertex_kernels::translate(std::span<Vertex> vertices, Vertex offset) {
+  kernels().add(floats(vertices), vertices.size() * 3,
+                pattern_of(offset).data());
+}
+
+void Vertex_kernels::scale(std::span<Vertex> vertices, float factor) {
+  kernels().mul(floats(vertices), vertices.size() * 3, factor);
+}
+
+void Vertex_kernels::transform(std::span<Vertex> vertices,
+                               const Matrix4 &matrix) {
+  if (is_translation(matrix))
+    translate(vertices, matrix.column(3));
+  else if (is_uniform_scale(matrix))
+    scale(vertices, matrix.m[0]);
+  else
+    kernels().transform(vertices.data(), vertices.size(), matrix);
+}
+
+void Vertex_kernels::normalize(std::span<Vertex> vertices, Vertex center,
+                               float divisor) {
+  kernels().sub_div(floats(vertices), vertices.size() * 3,
+                    pattern_of(center).data(), divisor);
+}
+
+void Vertex_kernels::bounds(const Vertex_soa &vertices, Vertex &min,
+                            Vertex &max) {
+  bounds_of(vertices.x, min.x, max.x);
+  bounds_of(vertices.y, min.y, max.y);
+  bounds_of(vertices.z, min.z, max.z);
+}
+
+void Vertex_kernels::translate(Vertex_soa &vertices, Vertex offset) {
+  const Kernels &k = kernels();
+  k.add(vertices.x.data(), vertices.size(), pattern_of(offset.x).data());
+  k.add(vertices.y.data(), vertices.size(), pattern_of(offset.y).data());
+  k.add(vertices.z.data(), vertices.size(), pattern_of(offset.z).data());
+}
+
+void Vertex_kernels::scale(Vertex_soa &vertices, float factor) {
+  const Kernels &k = kernels();
+  k.mul(vertices.x.data(), vertices.size(), factor);
+  k.mul(vertices.y.data(), vertices.size(), factor);
+  k.mul(vertices.z.data(), vertices.size(), factor);
+}
+
+void Vertex_kernels::transform(Vertex_soa &vertices, const Matrix4 &matrix) {
+  kernels().transform_soa(vertices.x.data(), vertices.y.data(),
+                          vertices.z.data(), vertices.size(), matrix);
+}
+
+void Vertex_kernels::normalize(Vertex_soa &vertices, Vertex center,
+                               float divisor) {
+  const Kernels &k = kernels();
+  k.sub_div(vertices.x.data(), vertices.size(), pattern_of(center.x).data(),
+            divisor);
+  k.sub_div(vertices.y.data(), vertices.size(), pattern_of(center.y).data(),
+            divisor);
+  k.sub_div(vertices.z.data(), vertices.size(), pattern_of(center.z).data(),
+            divisor);
+}
+
+}  // namespace s21
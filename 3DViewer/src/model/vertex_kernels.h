@@ -0,0 +1,109 @@
+/**
+ * @file vertex_kernels.h
+ * @brief Векторизованные (SSE2/AVX2) операции над массивами вершин.
+ *
+ * Сдвиг, масштаб, аффинное преобразование, рамка (min/max) и нормализация
+ * для миллионов вершин. Набор инструкций выбирается при запуске по
+ * возможностям процессора; на других архитектурах работает скалярный код.
+ */
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "common.h"
+
+namespace s21 {
+/**
+ * @struct Vertex_soa
+ * @brief Вершины в виде структуры массивов: отдельно все x, все y, все z.
+ *
+ * В таком виде каждая операция читает и пишет подряд идущие числа, и
+ * векторный код обрабатывает 8 вершин за инструкцию без перестановок.
+ * Необязательное хранилище: модель хранит Vertices, а Vertex_soa удобен
+ * для длинных цепочек расчётов над одной и той же геометрией.
+ */
+struct Vertex_soa {
+  std::vector<float> x, y, z;
+
+  size_t size() const { return x.size(); }
+
+  /**
+   * @brief Раскладывает массив вершин по координатам.
+   */
+  static Vertex_soa from(std::span<const Vertex> vertices);
+
+  /**
+   * @brief Собирает вершины обратно в обычный массив.
+   */
+  Vertices to_vertices() const;
+};
+
+/**
+ * @class Vertex_kernels
+ * @brief Набор ядер над массивами вершин с выбором SSE2/AVX2/скаляра.
+ *
+ * Все варианты выполняют одни и те же операции с плавающей точкой в одном
+ * и том же порядке (без FMA), поэтому результат побитово совпадает со
+ * скалярным кодом и с прежними циклами Model.
+ */
+class Vertex_kernels {
+ public:
+  /**
+   * @enum Simd
+   * @brief Уровень векторных инструкций.
+   */
+  enum class Simd { Scalar, Sse2, Avx2 };
+
+  /**
+   * @brief Лучший уровень, который поддерживает процессор.
+   */
+  static Simd supported();
+
+  /**
+   * @brief Уровень, используемый сейчас.
+   */
+  static Simd simd();
+
+  /**
+   * @brief Выбирает уровень (не выше поддерживаемого); нужно для тестов и
+   * замеров.
+   */
+  static void set_simd(Simd level);
+
+  /**
+   * @brief Рамка вершин; для пустого массива min = FLT_MAX, max = lowest.
+   */
+  static void bounds(std::span<const Vertex> vertices, Vertex &min,
+                     Vertex &max);
+
+  /**
+   * @brief `v = v + offset`.
+   */
+  static void translate(std::span<Vertex> vertices, Vertex offset);
+
+  /**
+   * @brief `v = v * factor`.
+   */
+  static void scale(std::span<Vertex> vertices, float factor);
+
+  /**
+   * @brief `v = matrix.apply(v)`; чистый сдвиг и масштаб идут через
+   * translate() и scale().
+   */
+  static void transform(std::span<Vertex> vertices, const Matrix4 &matrix);
+
+  /**
+   * @brief `v = (v - center) / divisor`; делитель не проверяется на ноль.
+   */
+  static void normalize(std::span<Vertex> vertices, Vertex center,
+                        float divisor);
+
+  static void bounds(const Vertex_soa &vertices, Vertex &min, Vertex &max);
+  static void translate(Vertex_soa &vertices, Vertex offset);
+  static void scale(Vertex_soa &vertices, float factor);
+  static void transform(Vertex_soa &vertices, const Matrix4 &matrix);
+  static void normalize(Vertex_soa &vertices, Vertex center, float divisor);
+};
+}  // namespace s21
@@ -36,6 +36,131 @@ TEST(ParserTest, parserTest) {
   ASSERT_EQ(parser.raw_polygons.size(), 6);
 }
 
+TEST(ParserTest, pipeFallbackTest) {
+  const std::string fifo = "tests/tests_files/cube.fifo";
+  std::remove(fifo.c_str());
+  ASSERT_EQ(mkfifo(fifo.c_str(), 0600), 0);
+  std::thread writer([&fifo] {
+    std::ifstream src("tests/tests_files/cube.obj");
+    std::ofstream dst(fifo);
+    dst << src.rdbuf();
+  });
+  Parser parser;
+  parser.initParser(fifo);
+  writer.join();
+  std::remove(fifo.c_str());
+  ASSERT_EQ(parser.response, Response::NormalDone);
+  ASSERT_EQ(parser.vertices.size(), 8);
+  ASSERT_EQ(parser.raw_polygons.size(), 6);
+}
+
+TEST(ParserTest, relativeIndexTest) {
+  Parser parser;
+  parser.initParser("tests/tests_files/interleaved_relative.obj");
+  ASSERT_EQ(parser.response, Response::NormalDone);
+  ASSERT_EQ(parser.vertices.size(), 4);
+  ASSERT_EQ(parser.polygons.size(), 2);
+  ASSERT_EQ(parser.raw_polygons.size(), 1);
+  auto hasTriangle = [&parser](Triangle t) {
+    return polygonsEq({t}, {parser.polygons[0]}) ||
+           polygonsEq({t}, {parser.polygons[1]});
+  };
+  ASSERT_TRUE(hasTriangle({0, 1, 2}));
+  ASSERT_TRUE(hasTriangle({0, 1, 3}));
+  ASSERT_EQ(parser.raw_polygons.indices, (std::vector<int>{3, 2, 1, 0}));
+}
+
+TEST(ParserTest, tokensTest) {
+  Parser parser;
+  parser.initParser("tests/tests_files/tokens.obj");
+  ASSERT_EQ(parser.response, Response::NormalDone);
+  ASSERT_EQ(verticesEq(parser.vertices, {{1.5f, -2.0f, 0.25f},
+                                         {100.0f, 0.0f, 0.0f},
+                                         {0.0f, 1.0f, 0.0f}}),
+            true);
+  ASSERT_EQ(parser.polygons.size(), 3);
+  ASSERT_EQ(parser.raw_polygons.size(), 0);
+  for (const auto &p : parser.polygons) {
+    ASSERT_EQ(p.v1 + p.v2 + p.v3, 3);
+  }
+}
+
+TEST(ParserTest, parallelTest) {
+  const std::string fname = "tests/tests_files/parallel.obj";
+  {
+    std::ofstream out(fname);
+    for (int i = 0; i < 60000; ++i) {
+      out << "v " << i << ".25 " << -i << ".5 " << i % 97 << ".125\n";
+      out << "v " << i % 13 << " " << i % 7 << " " << i << "\n";
+      out << "v 0.5 " << i << " -1.75\n";
+      out << "f -1 -2 -3\n";
+      out << "f " << 3 * i + 1 << "/1 " << 3 * i + 2 << "//2 -1 -" << 3 * i + 5
+          << "\n";
+      if (i % 1000 == 0) out << "# comment\nf 1 2\n";
+    }
+  }
+  Parser serial, parallel;
+  serial.initParser(fname);
+  parallel.initParser(fname, 4);
+  std::remove(fname.c_str());
+  ASSERT_EQ(serial.response, Response::NormalDone);
+  ASSERT_EQ(parallel.response, Response::NormalDone);
+  ASSERT_EQ(serial.vertices.size(), 180000);
+  ASSERT_EQ(verticesEq(serial.vertices, parallel.vertices), true);
+  ASSERT_EQ(polygonsEq(serial.polygons, parallel.polygons), true);
+  ASSERT_EQ(serial.raw_polygons, parallel.raw_polygons);
+}
+
+TEST(ParserTest, compressedTest) {
+  const std::string fname = "tests/tests_files/compressed.obj";
+  std::string text;
+  for (int i = 0; i < 100000; ++i) {
+    text += "v " + std::to_string(i) + ".5 " + std::to_string(-i) + " 1\n";
+    if (i >= 2) text += "f -1 -2 -3\n";
+  }
+  {
+    std::ofstream out(fname);
+    out << text;
+  }
+  // Два склеенных gzip-архива, как после `cat a.gz b.gz`
+  size_t half = text.find('\n', text.size() / 2) + 1;
+  gzFile gz = gzopen((fname + ".gz").c_str(), "wb");
+  gzwrite(gz, text.data(), half);
+  gzclose(gz);
+  gz = gzopen((fname + ".gz").c_str(), "ab");
+  gzwrite(gz, text.data() + half, text.size() - half);
+  gzclose(gz);
+
+  Parser plain, packed;
+  plain.initParser(fname);
+  packed.initParser(fname + ".gz");
+  ASSERT_EQ(packed.response, Response::NormalDone);
+  ASSERT_EQ(plain.vertices.size(), 100000);
+  ASSERT_EQ(verticesEq(plain.vertices, packed.vertices), true);
+  ASSERT_EQ(polygonsEq(plain.polygons, packed.polygons), true);
+
+  // Обрезанный архив не принимается за модель
+  std::filesystem::resize_file(fname + ".gz",
+                               std::filesystem::file_size(fname + ".gz") / 2);
+  packed.initParser(fname + ".gz");
+  ASSERT_EQ(packed.response, Response::BadFile);
+  ASSERT_EQ(packed.vertices.size(), 0);
+
+  // Стандартный ввод
+  int saved = dup(STDIN_FILENO);
+  int fd = open("tests/tests_files/cube.obj", O_RDONLY);
+  dup2(fd, STDIN_FILENO);
+  close(fd);
+  packed.initParser("-");
+  dup2(saved, STDIN_FILENO);
+  close(saved);
+  std::remove(fname.c_str());
+  std::remove((fname + ".gz").c_str());
+  ASSERT_EQ(packed.response, Response::NormalDone);
+  ASSERT_EQ(packed.vertices.size(), 8);
+  ASSERT_EQ(packed.raw_polygons.size(), 6);
+}
+
 TEST(ControllerTest, badModelTest) {
   Controller controller;
 
@@ -63,6 +188,189 @@ TEST(ControllerTest, badModelTest) {
   ASSERT_EQ(model.raw_polygons.size(), 0);
 }
 
+TEST(ControllerTest, asyncLoadTest) {
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/badpoly.obj"));
+
+  controller.loadModelAsync("tests/tests_files/cube.obj");
+  ASSERT_EQ(controller.isLoading(), true);
+  while (!controller.finishLoad()) std::this_thread::yield();
+  const Model &model = controller.getModel();
+  ASSERT_EQ(controller.isLoading(), false);
+  ASSERT_EQ(model.response, Response::NormalDone);
+  ASSERT_EQ(model.vertices.size(), 8);
+  ASSERT_EQ(model.raw_polygons.size(), 6);
+
+  Parser parser;
+  Load_progress progress;
+  progress.cancelled = true;
+  parser.initParser("tests/tests_files/cube.obj", 1, &progress);
+  ASSERT_EQ(parser.response, Response::Cancelled);
+  ASSERT_EQ(parser.vertices.size(), 0);
+
+  controller.loadModelAsync("tests/tests_files/badpoly.obj");
+  controller.cancelLoad();
+  ASSERT_EQ(controller.isLoading(), false);
+  ASSERT_EQ(model.vertices.size(), 8);
+
+  // Отменённая загрузка не мешает следующей
+  controller.loadModelAsync("tests/tests_files/badpoly.obj");
+  controller.loadModelAsync("tests/tests_files/cube.obj");
+  while (!controller.finishLoad()) std::this_thread::yield();
+  ASSERT_EQ(controller.getModel().vertices.size(), 8);
+}
+
+TEST(ControllerTest, historyTest) {
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/before_rotate.obj"));
+  const Model &model = controller.getModel();
+  const Vertices loaded = model.vertices;
+  ASSERT_EQ(controller.canUndo(), false);
+
+  controller.executeCommand(
+      std::make_unique<TranslateCommand>(Vertex{1.0f, 2.0f, 3.0f}, false));
+  Matrix4 translated = model.transform;
+  controller.executeCommand(
+      std::make_unique<RotateCommand>(Vertex{10.0f, 20.0f, 0.0f}, false));
+  Matrix4 rotated = model.transform;
+  controller.executeCommand(std::make_unique<BakeCommand>());
+  Vertices baked = model.vertices;
+  controller.executeCommand(std::make_unique<ScaleCommand>(2.0f, false));
+  Matrix4 scaled = model.transform;
+
+  // Матрица восстанавливается точно, без повтора команд
+  ASSERT_EQ(controller.undo(), true);
+  ASSERT_EQ(model.transform.is_identity(), true);
+  ASSERT_EQ(verticesEq(model.vertices, baked), true);
+  // Отмена bake(): загруженная геометрия и повтор первых двух команд
+  ASSERT_EQ(controller.undo(), true);
+  ASSERT_EQ(model.transform == rotated, true);
+  ASSERT_EQ(std::memcmp(model.vertices.data(), loaded.data(),
+                        loaded.size() * sizeof(Vertex)),
+            0);
+  ASSERT_EQ(controller.undo(), true);
+  ASSERT_EQ(model.transform == translated, true);
+
+  ASSERT_EQ(controller.redo(), true);
+  ASSERT_EQ(controller.redo(), true);
+  ASSERT_EQ(controller.redo(), true);
+  ASSERT_EQ(std::memcmp(model.vertices.data(), baked.data(),
+                        baked.size() * sizeof(Vertex)),
+            0);
+  ASSERT_EQ(model.transform == scaled, true);
+  ASSERT_EQ(controller.canRedo(), false);
+
+  // Новая команда отбрасывает отменённые
+  ASSERT_EQ(controller.undo(), true);
+  controller.executeCommand(std::make_unique<NormalizeCommand>());
+  ASSERT_EQ(controller.canRedo(), false);
+
+  // Вытеснение bake() из истории запрещает отмену через повтор
+  for (size_t i = 0; i < Controller::kHistoryLimit; i++)
+    controller.executeCommand(std::make_unique<ScaleCommand>(1.0f, false));
+  ASSERT_EQ(controller.undo(), true);
+  controller.executeCommand(std::make_unique<ScaleCommand>(2.0f, false));
+  controller.executeCommand(std::make_unique<BakeCommand>());
+  ASSERT_EQ(controller.canUndo(), false);
+  ASSERT_EQ(controller.undo(), false);
+
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/cube.obj"));
+  ASSERT_EQ(controller.canUndo(), false);
+  ASSERT_EQ(controller.canRedo(), false);
+}
+
+TEST(ControllerTest, queueTest) {
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/before_rotate.obj"));
+  const Model &model = controller.getModel();
+
+  Model expected = model;
+  for (int i = 0; i < 5; i++) expected.translate({0.0f, 1.0f, 0.0f}, true);
+  expected.rotate({0.0f, 0.0f, 30.0f}, false);
+  expected.rotate({10.0f, 0.0f, 0.0f}, false);
+  expected.scale(2.0f, false);
+  expected.scale(4.0f, true);
+  expected.bake();
+
+  for (int i = 0; i < 5; i++)
+    controller.enqueueCommand(
+        std::make_unique<TranslateCommand>(Vertex{0.0f, 1.0f, 0.0f}, true));
+  controller.enqueueCommand(
+      std::make_unique<RotateCommand>(Vertex{0.0f, 0.0f, 10.0f}, false));
+  controller.enqueueCommand(
+      std::make_unique<RotateCommand>(Vertex{0.0f, 0.0f, 20.0f}, false));
+  controller.enqueueCommand(
+      std::make_unique<RotateCommand>(Vertex{10.0f, 0.0f, 0.0f}, false));
+  controller.enqueueCommand(std::make_unique<ScaleCommand>(2.0f, false));
+  controller.enqueueCommand(std::make_unique<ScaleCommand>(4.0f, true));
+  ASSERT_EQ(controller.hasPendingCommands(), true);
+  ASSERT_EQ(model.transform.is_identity(), true);
+
+  // Постановка в очередь ничего не выполняет, выполнение — по flush
+  ASSERT_EQ(controller.flushCommands(), true);
+  ASSERT_EQ(controller.hasPendingCommands(), false);
+  ASSERT_EQ(controller.flushCommands(), false);
+  controller.executeCommand(std::make_unique<BakeCommand>());
+  ASSERT_EQ(verticesEq(model.vertices, expected.vertices), true);
+
+  // Сдвиг, два поворота вокруг разных осей, масштаб и bake
+  int steps = 0;
+  while (controller.canUndo()) {
+    controller.undo();
+    steps++;
+  }
+  ASSERT_EQ(steps, 5);
+
+  // Обычная команда сначала выполняет очередь
+  controller.enqueueCommand(std::make_unique<ScaleCommand>(2.0f, false));
+  controller.executeCommand(std::make_unique<ScaleCommand>(3.0f, false));
+  ASSERT_EQ(controller.hasPendingCommands(), false);
+  ASSERT_EQ(std::abs(model.transform.m[0] - 6.0f) < TOL, true);
+}
+
+TEST(ParserTest, previewTest) {
+  Load_preview preview;
+  Load_progress progress;
+  progress.preview = &preview;
+  Parser parser;
+  parser.initParser("tests/tests_files/cube.obj", 1, &progress);
+  ASSERT_EQ(parser.response, Response::NormalDone);
+
+  Preview_batch batch;
+  ASSERT_EQ(preview.take(batch), true);
+  ASSERT_EQ(verticesEq(batch.vertices, parser.vertices), true);
+  ASSERT_EQ(batch.indices.size(), 6 * 2 * 3);
+  ASSERT_EQ(batch.edges.size(), 18 * 2);
+  // Забранное в предпросмотре не хранится
+  Preview_batch empty;
+  ASSERT_EQ(preview.take(empty), false);
+  ASSERT_EQ(empty.vertices.size(), 0);
+
+  // Грань с ещё не прочитанной вершиной пропускается, а следующая порция
+  // ссылается на вершины прошлых
+  Load_preview parts;
+  Faces faces;
+  faces.indices = {0, 1, 2, 0, 2, 3};
+  faces.offsets = {0, 3, 6};
+  parts.append(std::span(parser.vertices).first(3), faces, 0);
+  ASSERT_EQ(parts.take(empty), true);
+  ASSERT_EQ(empty.vertices.size(), 3);
+  ASSERT_EQ(empty.indices.size(), 3);
+  parts.append(std::span(parser.vertices).subspan(3, 1), faces, 1);
+  ASSERT_EQ(parts.take(empty), true);
+  ASSERT_EQ(empty.vertices.size(), 1);
+  ASSERT_EQ(empty.indices, (std::vector<unsigned>{0, 2, 3}));
+
+  Model model;
+  model.openModel("tests/tests_files/cube.obj");
+  for (auto &v : parser.vertices) v = (v - batch.center) / batch.scale;
+  ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
+}
+
 TEST(ModelTest, triangulationTest) {
   Controller controller;
   controller.executeCommand(
@@ -79,6 +387,76 @@ TEST(ModelTest, triangulationTest) {
   ASSERT_EQ(parser.raw_polygons.size(), 6);
 }
 
+TEST(ModelTest, edgesTest) {
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/cube.obj"));
+  // 12 треугольников куба: 12 рёбер граней и 6 диагоналей
+  ASSERT_EQ(controller.getEdges().size(), 18);
+
+  std::mt19937 gen(5);
+  std::uniform_int_distribution<int> index(0, 99999);
+  Model serial;
+  serial.vertices.resize(100000);
+  serial.polygons.resize((1 << 18) + 777);
+  for (auto &t : serial.polygons) t = {index(gen), index(gen), index(gen)};
+  Model parallel = serial;
+  parallel.setThreads(4);
+  serial.extractEdges();
+  parallel.extractEdges();
+  std::set<std::pair<int, int>> expected;
+  for (const Triangle &t : serial.polygons) {
+    expected.insert(std::minmax(t.v1, t.v2));
+    expected.insert(std::minmax(t.v2, t.v3));
+    expected.insert(std::minmax(t.v3, t.v1));
+  }
+  ASSERT_EQ(serial.edges.size(), expected.size());
+  auto it = expected.begin();
+  for (const Edge &e : serial.edges) {
+    ASSERT_EQ(e.v1, it->first);
+    ASSERT_EQ(e.v2, it->second);
+    ++it;
+  }
+  ASSERT_EQ(serial.edges, parallel.edges);
+  std::atomic<bool> cancelled{true};
+  ASSERT_TRUE(unique_edges(serial.polygons, serial.vertices.size(), nullptr,
+                           &cancelled)
+                  .empty());
+}
+
+TEST(ModelTest, changesTest) {
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/cube.obj"));
+  ASSERT_EQ(controller.takeChanges().topology, true);
+  ASSERT_EQ(controller.takeChanges().empty(), true);
+
+  // Преобразования меняют только матрицу
+  controller.executeCommand(
+      std::make_unique<TranslateCommand>(Vertex{1, 0, 0}, true));
+  ASSERT_EQ(controller.takeChanges().empty(), true);
+
+  // bake() и reset() меняют все вершины, но не топологию
+  auto expectAllVertices = [&] {
+    Mesh_changes changes = controller.takeChanges();
+    EXPECT_EQ(changes.topology, false);
+    EXPECT_EQ(changes.vertices_from, 0);
+    EXPECT_EQ(changes.vertices_to, 8);
+  };
+  controller.executeCommand(std::make_unique<BakeCommand>());
+  expectAllVertices();
+  controller.executeCommand(std::make_unique<ResetCommand>());
+  expectAllVertices();
+
+  Mesh_changes merged;
+  merged.mark_vertices(5, 9);
+  merged.mark_vertices(4, 4);
+  merged.mark_vertices(2, 3);
+  ASSERT_EQ(merged.vertices_from, 2);
+  ASSERT_EQ(merged.vertices_to, 9);
+  ASSERT_EQ(merged.empty(), false);
+}
+
 TEST(ModelTest, normalizationTest) {
   Controller controller;
   controller.executeCommand(
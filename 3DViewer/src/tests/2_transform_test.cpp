@@ -9,16 +9,20 @@ TEST(TransformTest, scaleTest) {
   model.scale(f, false);
   Parser parser;
   parser.initParser("tests/tests_files/cube_x2.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
   model.scale(f, true);
   parser.initParser("tests/tests_files/cube_norm.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
   f = 0.0f;
   model.scale(f, false);
   parser.initParser("tests/tests_files/cube_xk.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
   model.scale(f, true);
   parser.initParser("tests/tests_files/cube_norm.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
 }
 
@@ -29,14 +33,133 @@ TEST(TransformTest, translateTest) {
   model.translate(move, false);
   Parser parser;
   parser.initParser("tests/tests_files/cube_trans.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
   model.openModel("tests/tests_files/cube_norm.obj");
   move = {1.0f, 0.0f, 0.0f};
   model.translate(move, true);
   parser.initParser("tests/tests_files/cube_trans_k.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(model.vertices, parser.vertices), true);
 }
 
+TEST(TransformTest, matrixTest) {
+  Model model;
+  model.openModel("tests/tests_files/before_rotate.obj");
+  Vertices expected = model.vertices;
+  model.translate({0.5f, -1.0f, 2.0f}, false);
+  model.rotate({0.0f, 30.0f, 0.0f}, false);
+  model.scale(1.5f, false);
+  model.rotate({-45.0f, 0.0f, 0.0f}, false);
+  ASSERT_EQ(verticesEq(model.vertices, expected), true);
+
+  for (auto &v : expected) v = v + Vertex{0.5f, -1.0f, 2.0f};
+  RotateY rotate_y(30);
+  rotate_y.rotation(expected);
+  for (auto &v : expected) v = v * 1.5f;
+  RotateX rotate_x(-45);
+  rotate_x.rotation(expected);
+  model.bake();
+  ASSERT_EQ(model.transform.is_identity(), true);
+  ASSERT_EQ(verticesEq(model.vertices, expected), true);
+}
+
+TEST(TransformTest, simdKernelsTest) {
+  // Нечётный размер, чтобы попасть и в векторную часть, и в хвост
+  std::mt19937 gen(21);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+  Vertices source(1003);
+  for (auto &v : source) v = {dist(gen), dist(gen), dist(gen)};
+  Matrix4 matrix;
+  matrix.translate({0.5f, -1.0f, 2.0f});
+  matrix.scale(1.7f);
+  Vertices columns = {matrix.column(0), matrix.column(1), matrix.column(2),
+                      matrix.column(3)};
+  RotateZ(33).rotation(columns);
+  for (int c = 0; c < 4; c++) matrix.set_column(c, columns[c]);
+
+  auto run = [&](Vertices vertices, Vertex &min, Vertex &max) {
+    Vertex_kernels::transform(vertices, matrix);
+    Vertex_kernels::translate(vertices, {1.0f, 2.0f, 3.0f});
+    Vertex_kernels::scale(vertices, 0.25f);
+    Vertex_kernels::bounds(vertices, min, max);
+    Vertex_kernels::normalize(vertices, (max + min) / 2, 7.0f);
+    return vertices;
+  };
+  auto run_soa = [&](Vertices vertices, Vertex &min, Vertex &max) {
+    Vertex_soa soa = Vertex_soa::from(vertices);
+    Vertex_kernels::transform(soa, matrix);
+    Vertex_kernels::translate(soa, {1.0f, 2.0f, 3.0f});
+    Vertex_kernels::scale(soa, 0.25f);
+    Vertex_kernels::bounds(soa, min, max);
+    Vertex_kernels::normalize(soa, (max + min) / 2, 7.0f);
+    return soa.to_vertices();
+  };
+  auto same = [](const Vertices &a, const Vertices &b) {
+    return a.size() == b.size() &&
+           std::memcmp(a.data(), b.data(), a.size() * sizeof(Vertex)) == 0;
+  };
+
+  Vertex_kernels::Simd best = Vertex_kernels::supported();
+  Vertex_kernels::set_simd(Vertex_kernels::Simd::Scalar);
+  Vertex min, max, soa_min, soa_max;
+  Vertices expected = run(source, min, max);
+  Vertices expected_soa = run_soa(source, soa_min, soa_max);
+  Vertices reference = source;
+  for (auto &v : reference) v = matrix.apply(v);
+  Vertices vectorized = source;
+  Vertex_kernels::transform(vectorized, matrix);
+  ASSERT_EQ(same(vectorized, reference), true);
+  ASSERT_EQ(same(expected, expected_soa), true);
+
+  for (int level = 1; level <= static_cast<int>(best); level++) {
+    Vertex_kernels::set_simd(static_cast<Vertex_kernels::Simd>(level));
+    Vertex got_min, got_max;
+    ASSERT_EQ(same(run(source, got_min, got_max), expected), true);
+    ASSERT_EQ(same({got_min, got_max}, {min, max}), true);
+    ASSERT_EQ(same(run_soa(source, got_min, got_max), expected_soa), true);
+    ASSERT_EQ(same({got_min, got_max}, {soa_min, soa_max}), true);
+  }
+  Vertex_kernels::set_simd(best);
+
+  Vertices empty;
+  Vertex_kernels::bounds(empty, min, max);
+  ASSERT_EQ(min.x, std::numeric_limits<float>::max());
+  ASSERT_EQ(max.x, std::numeric_limits<float>::lowest());
+}
+
+TEST(TransformTest, threadPoolTest) {
+  Thread_pool pool(4);
+  ASSERT_EQ(pool.size(), 4u);
+  for (int round = 0; round < 50; round++) {
+    std::vector<int> hits(1000);
+    pool.run(hits.size(), [&](size_t i) { hits[i]++; });
+    ASSERT_EQ(std::count(hits.begin(), hits.end(), 1), 1000);
+  }
+  pool.run(0, [](size_t) { FAIL(); });
+}
+
+TEST(TransformTest, parallelTest) {
+  std::mt19937 gen(12);
+  std::uniform_real_distribution<float> dist(-50.0f, 80.0f);
+  Model serial;
+  // Больше порога и не кратно блоку
+  serial.vertices.resize((1 << 18) + 12345);
+  for (auto &v : serial.vertices) v = {dist(gen), dist(gen), dist(gen)};
+  Model parallel = serial;
+  parallel.setThreads(4);
+  for (Model *model : {&serial, &parallel}) {
+    model->translate({0.5f, -1.0f, 2.0f}, false);
+    model->rotate({0.0f, 30.0f, 0.0f}, false);
+    model->scale(1.5f, false);
+    model->normalization();
+    model->bake();
+  }
+  ASSERT_EQ(std::memcmp(serial.vertices.data(), parallel.vertices.data(),
+                        serial.vertices.size() * sizeof(Vertex)),
+            0);
+}
+
 TEST(Rotation, rotateStrategyX) {
   RotateX strategy(10);
   Apply_rotation_strategy affin_transform(&strategy);
@@ -82,6 +205,7 @@ TEST(Rotation, rotateMethod) {
   ASSERT_EQ(model.response, Response::NormalDone);
   Parser parser;
   parser.initParser("tests/tests_files/after_rotate_z.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
 }
 
@@ -94,6 +218,7 @@ TEST(Rotation, rotateMethodDefault) {
   ASSERT_EQ(model.response, Response::NormalDone);
   Parser parser;
   parser.initParser("tests/tests_files/after_rotate_x.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
   model.openModel("tests/tests_files/before_rotate.obj");
   ASSERT_EQ(model.response, Response::NormalDone);
@@ -101,6 +226,7 @@ TEST(Rotation, rotateMethodDefault) {
   model.rotate(move, true);
   ASSERT_EQ(model.response, Response::NormalDone);
   parser.initParser("tests/tests_files/after_rotate_y.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
   model.openModel("tests/tests_files/before_rotate.obj");
   ASSERT_EQ(model.response, Response::NormalDone);
@@ -108,9 +234,48 @@ TEST(Rotation, rotateMethodDefault) {
   model.rotate(move, true);
   ASSERT_EQ(model.response, Response::NormalDone);
   parser.initParser("tests/tests_files/after_rotate_z.obj");
+  model.bake();
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
 }
 
+TEST(Rotation, compositeTest) {
+  Model model;
+  model.openModel("tests/tests_files/before_rotate.obj");
+  ASSERT_EQ(model.response, Response::NormalDone);
+  Vertices expected = model.vertices;
+  RotateX(20).rotation(expected);
+  RotateY(30).rotation(expected);
+  RotateZ(40).rotation(expected);
+
+  Vertices vertices = model.vertices;
+  RotateComposite::euler({20.0f, 30.0f, 40.0f}).rotation(vertices);
+  ASSERT_EQ(verticesEq(vertices, expected), true);
+  model.rotate({20.0f, 30.0f, 40.0f}, false);
+  model.bake();
+  ASSERT_EQ(verticesEq(model.vertices, expected), true);
+
+  model.openModel("tests/tests_files/before_rotate.obj");
+  expected = model.vertices;
+  RotateZ(10).rotation(expected);
+  RotateComposite around_z = RotateComposite::axis_angle({0, 0, 2.0f}, 10);
+  model.rotate(around_z);
+  model.bake();
+  ASSERT_EQ(verticesEq(model.vertices, expected), true);
+
+  model.openModel("tests/tests_files/before_rotate.obj");
+  expected = model.vertices;
+  RotateX(90).rotation(expected);
+  float half = std::sqrt(0.5f);
+  RotateComposite quarter = RotateComposite::quaternion(half, half, 0, 0);
+  model.rotate(quarter);
+  model.bake();
+  ASSERT_EQ(verticesEq(model.vertices, expected), true);
+
+  ASSERT_THROW(RotateComposite::axis_angle({0, 0, 0}, 10),
+               std::invalid_argument);
+  ASSERT_THROW(RotateComposite::quaternion(0, 0, 0, 0), std::invalid_argument);
+}
+
 TEST(ResetTest, resetTest) {
   static Model model;
   model.openModel("tests/tests_files/cube.obj");
@@ -118,13 +283,30 @@ TEST(ResetTest, resetTest) {
   Parser parser;
   parser.initParser("tests/tests_files/cube_norm.obj");
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
+  Vertices loaded = model.vertices;
   Vertex move = {1.0f, -3.0f, 8.0f};
   float f = 3.5;
   model.translate(move, false);
   model.scale(f, false);
-  ASSERT_EQ(verticesEq(parser.vertices, model.vertices), false);
+  ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
+  ASSERT_EQ(model.transform.is_identity(), false);
   model.normalization();
+  ASSERT_EQ(model.isBaked(), false);
   ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
+  model.bake();
+  ASSERT_EQ(verticesEq(parser.vertices, model.vertices), true);
+
+  // Сброс возвращает загруженные вершины без чтения файла
+  model.rotate({10.0f, 20.0f, 30.0f}, false);
+  model.bake();
+  ASSERT_EQ(model.isBaked(), true);
+  model.translate(move, false);
+  model.reset();
+  ASSERT_EQ(model.transform.is_identity(), true);
+  ASSERT_EQ(model.isBaked(), false);
+  ASSERT_EQ(std::memcmp(model.vertices.data(), loaded.data(),
+                        loaded.size() * sizeof(Vertex)),
+            0);
 }
 
 }  // namespace s21
\ No newline at end of file
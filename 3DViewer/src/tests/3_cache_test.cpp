@@ -0,0 +1,155 @@
+#include <filesystem>
+
+#include "test.h"
+
+namespace s21 {
+
+// openModel() только помечает модель для кэша; записывает контроллер
+static bool saveCache(Model &model) {
+  return model.cache()->save(model.takeUnsavedSource(), model.vertices,
+                             model.polygons, model.raw_polygons, model.edges,
+                             model.bvh);
+}
+
+TEST(CacheTest, roundTripTest) {
+  const std::string dir = "tests/tests_files/cache";
+  std::filesystem::remove_all(dir);
+  Model parsed;
+  parsed.openModel("tests/tests_files/cube_mod_poly.obj");
+
+  {
+    // Контроллер пишет кэш в фоне; деструктор дожидается записи
+    Controller controller;
+    controller.executeCommand(std::make_unique<CacheCommand>(true, dir));
+    controller.loadModelAsync("tests/tests_files/cube_mod_poly.obj");
+    while (!controller.finishLoad()) std::this_thread::yield();
+  }
+  Mesh_cache cache(dir);
+  ASSERT_TRUE(std::filesystem::exists(
+      cache.path_for("tests/tests_files/cube_mod_poly.obj")));
+
+  Model reloaded;
+  reloaded.setCache(true, dir);
+  reloaded.openModel("tests/tests_files/cube_mod_poly.obj");
+  std::filesystem::remove_all(dir);
+  ASSERT_EQ(reloaded.response, Response::NormalDone);
+  ASSERT_EQ(verticesEq(parsed.vertices, reloaded.vertices), true);
+  ASSERT_EQ(polygonsEq(parsed.polygons, reloaded.polygons), true);
+  ASSERT_EQ(parsed.raw_polygons, reloaded.raw_polygons);
+  // Рёбра и дерево читаются из кэша в том же виде, в каком их строит
+  // загрузка
+  ASSERT_EQ(parsed.edges, reloaded.edges);
+  ASSERT_EQ(parsed.bvh.nodes(), reloaded.bvh.nodes());
+  ASSERT_EQ(parsed.bvh.points(), reloaded.bvh.points());
+}
+
+TEST(CacheTest, invalidationTest) {
+  const std::string dir = "tests/tests_files/cache";
+  const std::string fname = "tests/tests_files/cache_source.obj";
+  std::filesystem::remove_all(dir);
+  std::filesystem::copy_file("tests/tests_files/cube.obj", fname,
+                             std::filesystem::copy_options::overwrite_existing);
+  Model model;
+  model.setCache(true, dir);
+  model.openModel(fname);
+  ASSERT_EQ(model.polygons.size(), 12);
+  ASSERT_TRUE(saveCache(model));
+  Vertices vertices;
+  Polygons polygons;
+  Faces raw_polygons;
+  Edges edges;
+  Mesh_bvh bvh;
+  Mesh_cache cache(dir);
+  ASSERT_TRUE(cache.load(fname, vertices, polygons, raw_polygons, edges,
+                         bvh));
+
+  {
+    std::ofstream out(fname, std::ios::app);
+    out << "\nf 1 2 3\n";
+  }
+  ASSERT_FALSE(cache.load(fname, vertices, polygons, raw_polygons, edges,
+                         bvh));
+  model.openModel(fname);
+  ASSERT_EQ(model.polygons.size(), 13);
+  ASSERT_TRUE(saveCache(model));
+  ASSERT_TRUE(cache.load(fname, vertices, polygons, raw_polygons, edges,
+                         bvh));
+  ASSERT_EQ(polygons.size(), 13);
+
+  std::filesystem::remove(fname);
+  std::filesystem::remove_all(dir);
+}
+
+TEST(CacheTest, bvhTest) {
+  // Сетка 100 × 100 квадратов: несколько листьев BVH
+  const std::string dir = "tests/tests_files/cache";
+  const std::string fname = "tests/tests_files/cache_grid.obj";
+  std::filesystem::remove_all(dir);
+  {
+    std::ofstream out(fname);
+    for (int y = 0; y <= 100; y++)
+      for (int x = 0; x <= 100; x++) out << "v " << x << ' ' << y << " 0\n";
+    for (int y = 0; y < 100; y++)
+      for (int x = 0; x < 100; x++) {
+        int v = y * 101 + x + 1;
+        out << "f " << v << ' ' << v + 1 << ' ' << v + 102 << ' ' << v + 101
+            << '\n';
+      }
+  }
+  Model parsed;
+  parsed.setCache(true, dir);
+  parsed.openModel(fname);
+  ASSERT_TRUE(saveCache(parsed));
+  Model reloaded;
+  reloaded.setCache(true, dir);
+  reloaded.openModel(fname);
+  std::filesystem::remove(fname);
+  std::filesystem::remove_all(dir);
+  ASSERT_GT(parsed.bvh.nodes().size(), 1);
+  ASSERT_EQ(polygonsEq(parsed.polygons, reloaded.polygons), true);
+  ASSERT_EQ(parsed.edges, reloaded.edges);
+  ASSERT_EQ(parsed.bvh.nodes(), reloaded.bvh.nodes());
+  ASSERT_EQ(parsed.bvh.points(), reloaded.bvh.points());
+  // Восстановленное дерево пересчитывается так же, как построенное
+  for (Vertex &v : parsed.vertices) v = v * 2.0f;
+  for (Vertex &v : reloaded.vertices) v = v * 2.0f;
+  parsed.bvh.refit(parsed.vertices, parsed.polygons, nullptr);
+  reloaded.bvh.refit(reloaded.vertices, reloaded.polygons, nullptr);
+  ASSERT_EQ(parsed.bvh.nodes(), reloaded.bvh.nodes());
+}
+
+TEST(CacheTest, evictionTest) {
+  namespace fs = std::filesystem;
+  const std::string dir = "tests/tests_files/cache";
+  const std::string cube = "tests/tests_files/cube.obj";
+  const std::string poly = "tests/tests_files/cube_mod_poly.obj";
+  fs::remove_all(dir);
+  Model model;
+  model.setCache(true, dir);
+  model.openModel(cube);
+  ASSERT_TRUE(saveCache(model));
+  model.openModel(poly);
+  ASSERT_TRUE(saveCache(model));
+  Mesh_cache unlimited(dir);
+  uint64_t both = fs::file_size(unlimited.path_for(cube)) +
+                  fs::file_size(unlimited.path_for(poly));
+  fs::remove(unlimited.path_for(poly));
+
+  // Места на обе модели нет: вытесняется давно не использованная
+  model.setCache(true, dir, both - 1);
+  model.openModel(poly);
+  fs::last_write_time(unlimited.path_for(cube),
+                      fs::file_time_type::clock::now() - std::chrono::hours(1));
+  ASSERT_TRUE(saveCache(model));
+  ASSERT_FALSE(fs::exists(unlimited.path_for(cube)));
+  ASSERT_TRUE(fs::exists(unlimited.path_for(poly)));
+
+  // Модель больше ограничения не записывается
+  model.setCache(true, dir, 1);
+  model.openModel(cube);
+  ASSERT_FALSE(saveCache(model));
+  ASSERT_TRUE(fs::exists(unlimited.path_for(poly)));
+  fs::remove_all(dir);
+}
+
+}  // namespace s21
@@ -0,0 +1,132 @@
+#include "test.h"
+
+namespace s21 {
+
+namespace {
+
+// Случайная модель: треугольники из близких вершин, чтобы кластеры были
+// компактными, и несколько вершин без треугольников в конце
+Model random_model(size_t triangles) {
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<float> coord(-1, 1);
+  std::uniform_int_distribution<int> offset(0, 50);
+  Model model;
+  size_t count = triangles / 2 + 100;
+  model.vertices.resize(count + 5);
+  for (auto &v : model.vertices) v = {coord(gen), coord(gen), coord(gen)};
+  std::sort(model.vertices.begin(), model.vertices.begin() + count,
+            [](const Vertex &a, const Vertex &b) { return a.x < b.x; });
+  model.polygons.resize(triangles);
+  for (size_t i = 0; i < triangles; i++) {
+    int base = i / 2;
+    model.polygons[i] = {base + offset(gen), base + offset(gen),
+                         base + offset(gen)};
+  }
+  return model;
+}
+
+bool inside(const Bvh_node &node, const Vertex &v) {
+  return v.x >= node.min.x && v.y >= node.min.y && v.z >= node.min.z &&
+         v.x <= node.max.x && v.y <= node.max.y && v.z <= node.max.z;
+}
+
+void check_bvh(const Model &model, const Edges &edges) {
+  const auto &nodes = model.bvh.nodes();
+  const auto &points = model.bvh.points();
+  ASSERT_EQ(nodes[0].triangles_to, model.polygons.size());
+  ASSERT_EQ(nodes[0].edges_to, edges.size());
+  std::set<std::pair<int, int>> grouped;
+  for (const Edge &e : model.edges) grouped.insert({e.v1, e.v2});
+  ASSERT_EQ(grouped.size(), edges.size());
+  for (const Edge &e : edges) ASSERT_EQ(grouped.count({e.v1, e.v2}), 1);
+  ASSERT_EQ(points.size(), model.vertices.size());
+  ASSERT_EQ(std::set<int>(points.begin(), points.end()).size(),
+            points.size());
+  std::vector<bool> used(model.vertices.size());
+  for (const Triangle &t : model.polygons)
+    used[t.v1] = used[t.v2] = used[t.v3] = true;
+  ASSERT_GE(points.size() - nodes[0].points_to, 5);
+  for (size_t p = 0; p < points.size(); p++)
+    ASSERT_EQ(used[points[p]], p < nodes[0].points_to);
+
+  for (const Bvh_node &node : nodes) {
+    if (!node.leaf()) {
+      const Bvh_node &left = nodes[node.left], &right = nodes[node.right];
+      ASSERT_EQ(left.triangles_from, node.triangles_from);
+      ASSERT_EQ(left.triangles_to, right.triangles_from);
+      ASSERT_EQ(right.triangles_to, node.triangles_to);
+      ASSERT_EQ(left.edges_to, right.edges_from);
+      ASSERT_EQ(left.points_to, right.points_from);
+      ASSERT_TRUE(inside(node, left.min) && inside(node, left.max));
+      ASSERT_TRUE(inside(node, right.min) && inside(node, right.max));
+      continue;
+    }
+    ASSERT_LE(node.triangles_to - node.triangles_from,
+              Mesh_bvh::kClusterTriangles);
+    std::set<std::pair<int, int>> own;
+    std::set<int> own_points;
+    for (uint32_t i = node.triangles_from; i < node.triangles_to; i++) {
+      const Triangle &t = model.polygons[i];
+      own.insert(std::minmax(t.v1, t.v2));
+      own.insert(std::minmax(t.v2, t.v3));
+      own.insert(std::minmax(t.v3, t.v1));
+      own_points.insert({t.v1, t.v2, t.v3});
+      for (int v : {t.v1, t.v2, t.v3})
+        ASSERT_TRUE(inside(node, model.vertices[v]));
+    }
+    for (uint32_t e = node.edges_from; e < node.edges_to; e++)
+      ASSERT_EQ(own.count({model.edges[e].v1, model.edges[e].v2}), 1);
+    for (uint32_t p = node.points_from; p < node.points_to; p++)
+      ASSERT_EQ(own_points.count(points[p]), 1);
+  }
+}
+
+}  // namespace
+
+TEST(BvhTest, buildTest) {
+  Model serial = random_model(60000);
+  Polygons source = serial.polygons;
+  serial.extractEdges();
+  Edges edges = serial.edges;
+  Model parallel = serial;
+  serial.bvh.build(serial.vertices, serial.polygons, serial.edges, nullptr);
+  Thread_pool pool(4);
+  parallel.bvh.build(parallel.vertices, parallel.polygons, parallel.edges,
+                     &pool);
+  ASSERT_GT(serial.bvh.nodes().size(), 1);
+  check_bvh(serial, edges);
+
+  auto less = [](const Triangle &a, const Triangle &b) {
+    return std::tie(a.v1, a.v2, a.v3) < std::tie(b.v1, b.v2, b.v3);
+  };
+  Polygons sorted = serial.polygons;
+  std::sort(sorted.begin(), sorted.end(), less);
+  std::sort(source.begin(), source.end(), less);
+  ASSERT_EQ(polygonsEq(sorted, source), true);
+
+  ASSERT_EQ(polygonsEq(serial.polygons, parallel.polygons), true);
+  ASSERT_EQ(serial.edges, parallel.edges);
+  ASSERT_EQ(serial.bvh.points(), parallel.bvh.points());
+  ASSERT_EQ(serial.bvh.nodes(), parallel.bvh.nodes());
+}
+
+TEST(BvhTest, refitTest) {
+  Model model = random_model(20000);
+  model.extractEdges();
+  Edges edges = model.edges;
+  model.bvh.build(model.vertices, model.polygons, model.edges, nullptr);
+  model.rotate({40, 10, 0}, false);
+  model.translate({1, -2, 3}, false);
+  model.bake();
+  check_bvh(model, edges);
+  model.reset();
+  check_bvh(model, edges);
+
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/cube.obj"));
+  ASSERT_EQ(controller.getBvh().nodes().size(), 1);
+  ASSERT_EQ(controller.getBvh().points().size(), 8);
+}
+
+}  // namespace s21
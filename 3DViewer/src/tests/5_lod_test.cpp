@@ -0,0 +1,98 @@
+#include "test.h"
+
+namespace s21 {
+
+namespace {
+
+// Единичная сфера из колец и сегментов: 2 · segments · (rings − 1)
+// треугольников
+Model sphere(int rings, int segments) {
+  Model model;
+  model.vertices.push_back({0, 0, 1});
+  for (int r = 1; r < rings; r++) {
+    float theta = M_PI * r / rings;
+    for (int s = 0; s < segments; s++) {
+      float phi = 2 * M_PI * s / segments;
+      model.vertices.push_back({std::sin(theta) * std::cos(phi),
+                                std::sin(theta) * std::sin(phi),
+                                std::cos(theta)});
+    }
+  }
+  int south = model.vertices.size();
+  model.vertices.push_back({0, 0, -1});
+  auto ring = [&](int r, int s) {
+    return 1 + (r - 1) * segments + s % segments;
+  };
+  for (int s = 0; s < segments; s++) {
+    model.polygons.push_back({0, ring(1, s), ring(1, s + 1)});
+    model.polygons.push_back({south, ring(rings - 1, s + 1),
+                              ring(rings - 1, s)});
+  }
+  for (int r = 1; r + 1 < rings; r++) {
+    for (int s = 0; s < segments; s++) {
+      model.polygons.push_back(
+          {ring(r, s), ring(r + 1, s), ring(r + 1, s + 1)});
+      model.polygons.push_back(
+          {ring(r, s), ring(r + 1, s + 1), ring(r, s + 1)});
+    }
+  }
+  return model;
+}
+
+}  // namespace
+
+TEST(LodTest, levelsTest) {
+  Model model = sphere(300, 1000);
+  ASSERT_GE(model.polygons.size(), Mesh_simplifier::kMinTriangles);
+  Lod_levels levels = Mesh_simplifier().build(model.vertices, model.polygons);
+  ASSERT_FALSE(levels.empty());
+  size_t previous = model.polygons.size();
+  for (const Lod_level &level : levels) {
+    ASSERT_LT(level.polygons.size() * 2, previous);
+    ASSERT_GE(level.polygons.size(), Mesh_simplifier::kCoarsestTriangles / 4);
+    previous = level.polygons.size();
+    int count = level.vertices.size();
+    for (const Triangle &t : level.polygons) {
+      ASSERT_TRUE(t.v1 >= 0 && t.v1 < count && t.v2 >= 0 && t.v2 < count &&
+                  t.v3 >= 0 && t.v3 < count);
+      ASSERT_TRUE(t.v1 != t.v2 && t.v2 != t.v3 && t.v3 != t.v1);
+    }
+    // Квадрики держат вершины на поверхности
+    for (const Vertex &v : level.vertices)
+      ASSERT_NEAR(std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z), 1.0, 0.02);
+    ASSERT_EQ(level.edges,
+              unique_edges(level.polygons, level.vertices.size(), nullptr));
+  }
+  ASSERT_LT(levels.back().polygons.size(), Mesh_simplifier::kMinTriangles);
+}
+
+TEST(LodTest, simplifyTest) {
+  // Сетка крупнее модели оставляет вершины на месте
+  Model cube;
+  cube.openModel("tests/tests_files/cube.obj");
+  Lod_level same = Mesh_simplifier().simplify(cube.vertices, cube.polygons,
+                                              1000);
+  ASSERT_EQ(same.polygons.size(), cube.polygons.size());
+  ASSERT_EQ(same.vertices.size(), cube.vertices.size());
+  // Одна ячейка стягивает всё в точку
+  Lod_level point = Mesh_simplifier().simplify(cube.vertices, cube.polygons,
+                                               1);
+  ASSERT_TRUE(point.polygons.empty());
+  ASSERT_TRUE(Mesh_simplifier().build(cube.vertices, cube.polygons).empty());
+
+  Model model = sphere(300, 1000);
+  std::atomic<bool> cancelled{true};
+  Mesh_simplifier cancelled_simplifier(&cancelled);
+  ASSERT_TRUE(
+      cancelled_simplifier.build(model.vertices, model.polygons).empty());
+  ASSERT_TRUE(cancelled_simplifier.simplify(model.vertices, model.polygons, 100)
+                  .polygons.empty());
+
+  Controller controller;
+  controller.executeCommand(
+      std::make_unique<OpenFileCommand>("tests/tests_files/cube.obj"));
+  ASSERT_FALSE(controller.isBuildingLod());
+  ASSERT_TRUE(controller.getLods().empty());
+}
+
+}  // namespace s21
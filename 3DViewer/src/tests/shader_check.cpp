@@ -0,0 +1,102 @@
+/**
+ * @file shader_check.cpp
+ * @brief Компилирует и линкует шейдеры GLWidget без Qt и без окна.
+ *
+ * Создаёт контекст OpenGL 3.3 core через EGL без поверхности (например,
+ * Mesa llvmpipe) и собирает те же программы, что и GLWidget. Запуск:
+ * `make shader_check`; код возврата ненулевой, если контекст не создан или
+ * программа не собралась.
+ */
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#define GL_GLEXT_PROTOTYPES
+#include <GL/gl.h>
+#include <GL/glext.h>
+
+#include <cstdio>
+
+#include "../gui/shaders.h"
+
+namespace {
+
+// Компилирует шейдер; 0 при ошибке (журнал выводится)
+GLuint compile(GLenum type, const char *source, const char *name) {
+  GLuint shader = glCreateShader(type);
+  glShaderSource(shader, 1, &source, nullptr);
+  glCompileShader(shader);
+  GLint ok = GL_FALSE;
+  glGetShaderiv(shader, GL_COMPILE_STATUS, &ok);
+  if (!ok) {
+    char log[4096];
+    glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    std::printf("%s: compile failed\n%s\n", name, log);
+    return 0;
+  }
+  return shader;
+}
+
+// Собирает программу как GLWidget::initializeCore(); geometry может быть
+// nullptr
+bool link(const char *name, const char *vertex, const char *geometry,
+          const char *fragment) {
+  GLuint shaders[] = {compile(GL_VERTEX_SHADER, vertex, name),
+                      geometry ? compile(GL_GEOMETRY_SHADER, geometry, name)
+                               : GLuint(0),
+                      compile(GL_FRAGMENT_SHADER, fragment, name)};
+  if (!shaders[0] || (geometry && !shaders[1]) || !shaders[2]) return false;
+  GLuint program = glCreateProgram();
+  for (GLuint shader : shaders)
+    if (shader) glAttachShader(program, shader);
+  glLinkProgram(program);
+  GLint ok = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &ok);
+  if (!ok) {
+    char log[4096];
+    glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+    std::printf("%s: link failed\n%s\n", name, log);
+    return false;
+  }
+  std::printf("%s: OK\n", name);
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  EGLDisplay display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                             EGL_DEFAULT_DISPLAY, nullptr);
+  if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr)) {
+    std::printf("no EGL display without a surface\n");
+    return 1;
+  }
+  eglBindAPI(EGL_OPENGL_API);
+  const EGLint attributes[] = {EGL_CONTEXT_MAJOR_VERSION,
+                               3,
+                               EGL_CONTEXT_MINOR_VERSION,
+                               3,
+                               EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                               EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                               EGL_NONE};
+  EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR,
+                                        EGL_NO_CONTEXT, attributes);
+  if (context == EGL_NO_CONTEXT ||
+      !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+    std::printf("no OpenGL 3.3 core context\n");
+    eglTerminate(display);
+    return 1;
+  }
+  std::printf("%s, %s\n", glGetString(GL_RENDERER), glGetString(GL_VERSION));
+
+  using namespace s21::shaders;
+  bool ok = link("mesh", kMeshVertexShader, nullptr, kColorFragmentShader);
+  ok = link("line", kMeshVertexShader, kLineGeometryShader,
+            kLineFragmentShader) &&
+       ok;
+  ok = link("point", kPointVertexShader, nullptr, kPointFragmentShader) && ok;
+
+  eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  eglDestroyContext(display, context);
+  eglTerminate(display);
+  return ok ? 0 : 1;
+}
@@ -21,15 +21,24 @@ bool verticesEq(Vertices v1, Vertices v2) {
   return result;
 }
 
+bool polygonsEq(const Polygons &p1, const Polygons &p2) {
+  bool result = p1.size() == p2.size();
+  for (size_t i = 0; i < p1.size() && result; ++i) {
+    result = p1[i].v1 == p2[i].v1 && p1[i].v2 == p2[i].v2 &&
+             p1[i].v3 == p2[i].v3;
+  }
+  return result;
+}
+
 void printVertices(Vertices vertices) {
   for (const auto &v : vertices) std::cout << v << std::endl;
 }
 void printPolygons(std::vector<Triangle> polygons) {
   for (const auto &p : polygons) std::cout << p << std::endl;
 }
-void printRawPolygons(std::vector<std::vector<int>> raw_polygons) {
-  for (const auto &rp : raw_polygons) {
-    for (const auto &idx : rp) std::cout << idx << " ";
+void printRawPolygons(const Faces &raw_polygons) {
+  for (size_t i = 0; i < raw_polygons.size(); ++i) {
+    for (const auto &idx : raw_polygons[i]) std::cout << idx << " ";
     std::cout << std::endl;
   }
 }
@@ -1,19 +1,34 @@
 #pragma once
+#include <fcntl.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
 
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <queue>
+#include <set>
 #include <stack>
+#include <thread>
 
 #include "../controller/controller.h"
 // #include "../model/model.h"
+#include "../model/edges.h"
+#include "../model/load_preview.h"
+#include "../model/mesh_bvh.h"
+#include "../model/mesh_cache.h"
+#include "../model/mesh_lod.h"
 #include "../model/parser.h"
 #include "../model/rotate_strategy.h"
+#include "../model/vertex_kernels.h"
 
 #define TOL 1e-6  // Точность сравнения
 namespace s21 {
 bool verticesEq(Vertices v1, Vertices v2);
+bool polygonsEq(const Polygons &p1, const Polygons &p2);
 void printVertices(Vertices vertices);
 void printPolygons(std::vector<Triangle> polygons);
-void printRawPolygons(std::vector<std::vector<int>> raw_polygons);
+void printRawPolygons(const Faces &raw_polygons);
 }  // namespace s21
\ No newline at end of file